@@ -0,0 +1,122 @@
+#include "Benchmark.h"
+#include "CommandLine.h"
+#include "Universe.h"
+#include "GridArena.h"
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <string>
+
+Benchmark::Benchmark(const Config& config) {
+	this->config = config;
+}
+
+Benchmark::Result Benchmark::run(bool huge_pages) const {
+	GridArena::setHugePages(huge_pages); // only affects grids allocated from here on
+
+	Result result;
+	result.huge_pages = huge_pages;
+
+	Universe universe(5, 5, 0);
+	universe.setHistoryEnabled(false); // measure stepping, not recording
+	universe.setMemoryBudget(std::max(universe.getMemoryBudget(), universe.estimateMemory(this->config.width, this->config.height)));
+	universe.setThreadCount(this->config.threads);
+	universe.setThreadPinning(this->config.pin_threads);
+	universe.setBlockGenerations(this->config.block_generations);
+	int percent = this->config.load_file.empty() ? this->config.percent : 0;
+	if (!universe.initialize(this->config.width, this->config.height, percent, this->config.seed)) {
+		return result;
+	}
+
+	if (!this->config.load_file.empty()) {
+		Stamp pattern;
+		if (!pattern.loadFromFile(this->config.load_file, universe.getMemoryBudget())) {
+			return result;
+		} // loadFromFile printed why
+
+		int64_t x = (int64_t(this->config.width) - pattern.getWidth()) / 2;
+		int64_t y = (int64_t(this->config.height) - pattern.getHeight()) / 2;
+		universe.stamp(pattern, static_cast<int>(x), static_cast<int>(y), StampMode::Or); // a mostly empty board, the case where skipping settled tiles pays off
+	}
+
+	GridArena::Stats stats = GridArena::getStats();
+	result.page_kind = GridArena::getKindName(stats.file_bytes > 0 ? GridArena::PageKind::File
+		: stats.huge_bytes > 0 ? GridArena::PageKind::Huge
+		: stats.transparent_bytes > 0 ? GridArena::PageKind::Transparent
+		: stats.normal_bytes > 0 ? GridArena::PageKind::Normal
+		: GridArena::PageKind::Heap); // the benchmark's grids are the only large allocations
+
+	double cells = static_cast<double>(this->config.width) * this->config.height * this->config.generations;
+	auto timeBest = [this, cells](const std::function<void()>& body) {
+		double best = 0.0;
+		for (int i = 0; i < std::max(this->config.repeat, 1); i++) {
+			auto start = std::chrono::steady_clock::now();
+			body();
+			double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			best = std::max(best, seconds > 0.0 ? cells / seconds : 0.0);
+		}
+		return best;
+	}; // best of several runs, the first also faults in the step buffers
+
+	result.step_rate = timeBest([this, &universe]() {
+		universe.step(this->config.generations, false);
+	});
+	result.advance_rate = timeBest([this, &universe]() {
+		for (uint64_t i = 0; i < this->config.generations; i++) {
+			universe.nextGeneration(false);
+		}
+	});
+	return result;
+}
+
+bool Benchmark::parseArguments(int argc, char* argv[], Config& config) {
+	bool parsed = CommandLine::parseOptions(argc, argv, [&config](const std::string& option, const std::string& value) {
+		if (option == "--width") config.width = static_cast<int>(CommandLine::toInteger(value, 1, INT32_MAX));
+		else if (option == "--height") config.height = static_cast<int>(CommandLine::toInteger(value, 1, INT32_MAX));
+		else if (option == "--percent") config.percent = static_cast<int>(CommandLine::toInteger(value, 0, 100));
+		else if (option == "--seed") config.seed = static_cast<unsigned int>(CommandLine::toInteger(value, 0, UINT32_MAX));
+		else if (option == "--generations") config.generations = static_cast<uint64_t>(CommandLine::toInteger(value, 1, INT64_MAX));
+		else if (option == "--block") config.block_generations = static_cast<int>(CommandLine::toInteger(value, 1, 64));
+		else if (option == "--repeat") config.repeat = static_cast<int>(CommandLine::toInteger(value, 1, INT32_MAX));
+		else if (option == "--threads") config.threads = static_cast<unsigned int>(CommandLine::toInteger(value, 0, CommandLine::getMaxThreads()));
+		else if (option == "--pin") config.pin_threads = CommandLine::toInteger(value, 0, 1) != 0;
+		else if (option == "--huge-pages") config.huge_pages = static_cast<int>(CommandLine::toInteger(value, -1, 1));
+		else if (option == "--backing-dir") config.backing_directory = value;
+		else if (option == "--load") config.load_file = value;
+		else return false;
+		return true;
+	});
+	if (!parsed) return false;
+
+	if (config.width <= 0 || config.height <= 0 || config.percent < 0 || config.percent > 100 || config.generations == 0) {
+		std::cerr << "ERROR: Invalid benchmark board or generation count" << std::endl;
+		return false;
+	} // exit if the board can't be created
+
+	return true;
+}
+
+int Benchmark::runFromArguments(int argc, char* argv[]) {
+	Config config;
+	if (!Benchmark::parseArguments(argc, argv, config)) {
+		return 1;
+	}
+
+	GridArena::setBackingDirectory(config.backing_directory);
+	Benchmark benchmark(config);
+	std::cout << config.width << " x " << config.height << " board" << (config.load_file.empty() ? "" : " with " + config.load_file) << ", " << config.generations << " generations per run" << std::endl;
+
+	for (int huge_pages = 1; huge_pages >= 0; huge_pages--) {
+		if (config.huge_pages >= 0 && config.huge_pages != huge_pages) continue;
+
+		Result result = benchmark.run(huge_pages == 1);
+		if (result.step_rate == 0.0) {
+			return 1;
+		} // the board couldn't be created or the pattern loaded, both print why
+
+		std::cout << "huge pages " << (huge_pages ? "on " : "off") << " (" << result.page_kind << "): step "
+			<< result.step_rate / 1e9 << " Gcells/s, one generation at a time " << result.advance_rate / 1e9 << " Gcells/s" << std::endl;
+	}
+	return 0;
+}
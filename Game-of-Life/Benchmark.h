@@ -0,0 +1,39 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+// headless throughput benchmark on one large random board, run once with huge pages and once without
+class Benchmark {
+public:
+	struct Config {
+		int width = 16384;
+		int height = 16384;
+		int percent = 30;
+		unsigned int seed = 1;
+		uint64_t generations = 64; // per timed run
+		int block_generations = 8;
+		int repeat = 3; // the best run is reported
+		unsigned int threads = 0; // 0 uses every hardware thread
+		bool pin_threads = true;
+		int huge_pages = -1; // 1 only with huge pages, 0 only without, -1 both
+		std::string backing_directory; // map the grids from files here instead of memory
+		std::string load_file; // stamp this pattern on the middle of an empty board instead of a random one
+	};
+
+	struct Result {
+		bool huge_pages = false;
+		const char* page_kind = ""; // what the board's memory ended up with
+		double step_rate = 0.0; // cells per second through step(), temporally blocked
+		double advance_rate = 0.0; // cells per second one generation at a time
+	};
+
+	Benchmark(const Config& config);
+
+	Result run(bool huge_pages) const;
+
+	static bool parseArguments(int argc, char* argv[], Config& config); // --width, --height, --percent, --seed, --generations, --block, --repeat, --threads, --pin, --huge-pages, --backing-dir, --load
+	static int runFromArguments(int argc, char* argv[]); // entry point for --benchmark, returns the process exit code
+
+private:
+	Config config;
+};
@@ -0,0 +1,203 @@
+#include "BitGrid.h"
+#include <algorithm>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+BitGrid::BitGrid(int width, int height) {
+	this->resize(width, height);
+}
+
+void BitGrid::resize(int width, int height) {
+	this->allocate(width, height);
+	if (!this->isFileBacked()) {
+		std::fill(this->data.begin(), this->data.end(), 0);
+	} // a fresh backing file already reads as zeros, writing them would only push them to disk
+}
+
+void BitGrid::allocate(int width, int height) {
+	this->width = std::max(width, 0);
+	this->height = std::max(height, 0);
+	this->words_per_row = (this->width + 63) / 64;
+	this->row_stride = static_cast<int>(BitGrid::getRowStride(this->width));
+	this->data.clear();
+	this->data.shrink_to_fit(); // release the old buffer so the new one is fresh memory nobody has touched
+	this->data.resize(static_cast<size_t>(this->height) * this->row_stride);
+}
+
+void BitGrid::clear() {
+	std::fill(this->data.begin(), this->data.end(), 0);
+}
+
+void BitGrid::copyOverlap(const BitGrid& other) {
+	int rows = std::min(this->height, other.height);
+	int columns = std::min(this->width, other.width);
+	int full_words = columns / 64;
+	uint64_t tail_mask = (columns % 64) ? (~uint64_t(0) >> (64 - columns % 64)) : 0;
+
+	for (int y = 0; y < rows; y++) {
+		uint64_t* target = this->row(y);
+		const uint64_t* source = other.row(y);
+		std::copy(source, source + full_words, target);
+		if (tail_mask) {
+			target[full_words] = (target[full_words] & ~tail_mask) | (source[full_words] & tail_mask);
+		} // partial word at the edge of the smaller grid
+	}
+}
+
+int BitGrid::getWidth() const {
+	return this->width;
+}
+
+int BitGrid::getHeight() const {
+	return this->height;
+}
+
+int BitGrid::getWordsPerRow() const {
+	return this->words_per_row;
+}
+
+int BitGrid::getRowStride() const {
+	return this->row_stride;
+}
+
+bool BitGrid::isFileBacked() const {
+	return !this->data.empty() && GridArena::getKind(this->data.data()) == GridArena::PageKind::File;
+}
+
+bool BitGrid::empty() const {
+	return this->width == 0 || this->height == 0;
+}
+
+size_t BitGrid::getMemoryUsage() const {
+	return this->data.capacity() * sizeof(uint64_t);
+}
+
+bool BitGrid::isAlive(int x, int y) const {
+	return (this->row(y)[x / 64] >> (x % 64)) & 1;
+}
+
+void BitGrid::setAlive(int x, int y, bool alive) {
+	uint64_t bit = uint64_t(1) << (x % 64);
+	uint64_t& word = this->row(y)[x / 64];
+	word = alive ? (word | bit) : (word & ~bit);
+}
+
+uint64_t* BitGrid::row(int y) {
+	return this->data.data() + static_cast<size_t>(y) * this->row_stride;
+}
+
+const uint64_t* BitGrid::row(int y) const {
+	return this->data.data() + static_cast<size_t>(y) * this->row_stride;
+}
+
+GridWords& BitGrid::words() {
+	return this->data;
+}
+
+const GridWords& BitGrid::words() const {
+	return this->data;
+}
+
+uint64_t BitGrid::getLastWordMask() const {
+	return (this->width % 64) ? (~uint64_t(0) >> (64 - this->width % 64)) : ~uint64_t(0);
+}
+
+#pragma region Word helpers
+int64_t BitGrid::getRowStride(int64_t width) {
+	const int64_t line_words = GridArena::CACHE_LINE / sizeof(uint64_t);
+	return ((width + 63) / 64 + line_words - 1) / line_words * line_words;
+}
+
+int BitGrid::countTrailingZeros(uint64_t word) {
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward64(&index, word);
+	return static_cast<int>(index);
+#else
+	return __builtin_ctzll(word);
+#endif
+}
+
+int BitGrid::countLeadingZeros(uint64_t word) {
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanReverse64(&index, word);
+	return 63 - static_cast<int>(index);
+#else
+	return __builtin_clzll(word);
+#endif
+}
+
+int BitGrid::popCount(uint64_t word) {
+#ifdef _MSC_VER
+	return static_cast<int>(__popcnt64(word));
+#else
+	return __builtin_popcountll(word);
+#endif
+}
+
+uint64_t BitGrid::reverseBits(uint64_t word) {
+	word = ((word >> 1) & 0x5555555555555555ull) | ((word & 0x5555555555555555ull) << 1);
+	word = ((word >> 2) & 0x3333333333333333ull) | ((word & 0x3333333333333333ull) << 2);
+	word = ((word >> 4) & 0x0F0F0F0F0F0F0F0Full) | ((word & 0x0F0F0F0F0F0F0F0Full) << 4);
+	word = ((word >> 8) & 0x00FF00FF00FF00FFull) | ((word & 0x00FF00FF00FF00FFull) << 8);
+	word = ((word >> 16) & 0x0000FFFF0000FFFFull) | ((word & 0x0000FFFF0000FFFFull) << 16);
+	return (word >> 32) | (word << 32); // swap ever larger pieces
+}
+
+uint64_t BitGrid::getBits(const uint64_t* row, int words, int64_t first_column) {
+	int64_t index = first_column >= 0 ? first_column / 64 : -((63 - first_column) / 64); // rounded down for negative columns too
+	int shift = static_cast<int>(first_column - index * 64);
+	auto word = [row, words](int64_t k) {
+		return k >= 0 && k < words ? row[k] : uint64_t(0);
+	};
+
+	if (shift == 0) return word(index);
+	return (word(index) >> shift) | (word(index + 1) << (64 - shift)); // straddles two words
+}
+
+uint64_t BitGrid::wordHash(int y, int word_index, uint64_t word) {
+	if (word == 0) return 0; // empty words don't change the board's hash
+
+	uint64_t key = (static_cast<uint64_t>(static_cast<uint32_t>(y)) << 32) | static_cast<uint32_t>(word_index);
+	key = key * 0x9E3779B97F4A7C15ull ^ word;
+	key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ull;
+	key = (key ^ (key >> 27)) * 0x94D049BB133111EBull;
+	return key ^ (key >> 31); // splitmix64 finalizer
+}
+
+void BitGrid::stepRow(const uint64_t* above, const uint64_t* row, const uint64_t* below, uint64_t* out, int words, uint64_t last_mask) {
+	// count the eight neighbours of 64 cells at once with bitwise adders, each bit of the sums belongs to one cell
+	for (int k = 0; k < words; k++) {
+		uint64_t a = above[k], b = row[k], c = below[k];
+		uint64_t a_prev = k > 0 ? above[k - 1] : 0, b_prev = k > 0 ? row[k - 1] : 0, c_prev = k > 0 ? below[k - 1] : 0;
+		uint64_t a_next = k + 1 < words ? above[k + 1] : 0, b_next = k + 1 < words ? row[k + 1] : 0, c_next = k + 1 < words ? below[k + 1] : 0;
+
+		uint64_t a_west = (a << 1) | (a_prev >> 63), a_east = (a >> 1) | (a_next << 63);
+		uint64_t b_west = (b << 1) | (b_prev >> 63), b_east = (b >> 1) | (b_next << 63);
+		uint64_t c_west = (c << 1) | (c_prev >> 63), c_east = (c >> 1) | (c_next << 63);
+
+		// column sums, top and bottom rows have three cells and the middle row two
+		uint64_t top_xor = a_west ^ a;
+		uint64_t top_ones = top_xor ^ a_east, top_twos = (a_west & a) | (top_xor & a_east);
+		uint64_t mid_ones = b_west ^ b_east, mid_twos = b_west & b_east;
+		uint64_t bottom_xor = c_west ^ c;
+		uint64_t bottom_ones = bottom_xor ^ c_east, bottom_twos = (c_west & c) | (bottom_xor & c_east);
+
+		// add the ones, then the twos with the carry from the ones
+		uint64_t ones_xor = top_ones ^ mid_ones;
+		uint64_t ones = ones_xor ^ bottom_ones, ones_carry = (top_ones & mid_ones) | (ones_xor & bottom_ones);
+		uint64_t twos_xor = top_twos ^ mid_twos;
+		uint64_t twos_partial = twos_xor ^ bottom_twos, fours_partial = (top_twos & mid_twos) | (twos_xor & bottom_twos);
+		uint64_t twos = twos_partial ^ ones_carry, fours = fours_partial ^ (twos_partial & ones_carry);
+
+		// alive next generation with exactly 3 neighbours, or 2 if alive now (8 neighbours wraps to 0 and stays dead)
+		out[k] = twos & ~fours & (ones | b);
+	}
+
+	if (words > 0) {
+		out[words - 1] &= last_mask;
+	} // cells past the right edge never come alive
+}
+#pragma endregion
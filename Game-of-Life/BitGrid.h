@@ -0,0 +1,50 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include "GridAllocator.h"
+
+// one bit per cell, bit i of a row's word k is column 64 * k + i
+// rows are padded to whole words and the padding bits are always dead,
+// and each row starts on a cache line, the words between the end of one row and the next are always 0
+class BitGrid {
+public:
+	BitGrid(int width = 0, int height = 0);
+
+	void resize(int width, int height); // clears the board
+	void allocate(int width, int height); // like resize but leaves every word uninitialized (zero if file backed), the caller has to write them all
+	void clear();
+	void copyOverlap(const BitGrid& other); // copy the region both grids cover, used when resizing
+
+	int getWidth() const;
+	int getHeight() const;
+	int getWordsPerRow() const;
+	int getRowStride() const; // words from the start of one row to the next
+	bool isFileBacked() const; // whether the words live in the arena's backing file rather than memory
+	bool empty() const;
+	size_t getMemoryUsage() const;
+
+	bool isAlive(int x, int y) const;
+	void setAlive(int x, int y, bool alive);
+	uint64_t* row(int y);
+	const uint64_t* row(int y) const;
+	GridWords& words(); // every row including its padding to the next cache line
+	const GridWords& words() const;
+	uint64_t getLastWordMask() const; // bits of a row's last word that are on the board
+
+	// ---- word helpers ----
+	static int64_t getRowStride(int64_t width); // row stride of a grid this wide
+	static int countTrailingZeros(uint64_t word); // word must not be 0
+	static int countLeadingZeros(uint64_t word); // word must not be 0
+	static int popCount(uint64_t word);
+	static uint64_t reverseBits(uint64_t word); // bit i moves to bit 63 - i
+	static uint64_t getBits(const uint64_t* row, int words, int64_t first_column); // the 64 columns from first_column on as one word, columns outside the row's words read as 0
+	static uint64_t wordHash(int y, int word_index, uint64_t word); // 0 for an empty word, boards hash to the xor of their words
+	static void stepRow(const uint64_t* above, const uint64_t* row, const uint64_t* below, uint64_t* out, int words, uint64_t last_mask); // one generation of one row
+
+private:
+	int width = 0;
+	int height = 0;
+	int words_per_row = 0;
+	int row_stride = 0;
+	GridWords data;
+};
@@ -0,0 +1,375 @@
+#include "Census.h"
+#include "Universe.h"
+#include "WorkStealingPool.h"
+#include "BitGrid.h"
+#include <algorithm>
+#include <thread>
+
+Census::Census(unsigned int thread_count) {
+	this->thread_count = thread_count == 0 ? std::max(1u, std::thread::hardware_concurrency()) : thread_count;
+}
+
+void Census::run(const Universe& universe) {
+	std::vector<uint64_t> packed;
+	int width = 0, height = 0;
+	universe.copyPackedGrid(packed, width, height);
+	this->run(packed, width, height);
+}
+
+void Census::run(const std::vector<uint64_t>& packed, int width, int height) {
+	this->entries.clear();
+	this->object_count = 0;
+	if (width <= 0 || height <= 0) return; // nothing to count
+
+	WorkStealingPool pool(this->thread_count);
+
+	// label runs of live cells band by band, each band only unions runs inside itself
+	int band_count = std::max(1, std::min(static_cast<int>(this->thread_count) * 4, height / MIN_BAND_ROWS));
+	std::vector<Band> bands(band_count);
+	for (int i = 0; i < band_count; i++) {
+		bands[i].first_row = static_cast<int>(static_cast<int64_t>(height) * i / band_count);
+		bands[i].last_row = static_cast<int>(static_cast<int64_t>(height) * (i + 1) / band_count);
+		pool.submit([this, &bands, &packed, width, i]() {
+			this->labelBand(bands[i], packed, width);
+		});
+	}
+	pool.wait();
+
+	std::vector<uint32_t> band_offset(band_count + 1, 0);
+	for (int i = 0; i < band_count; i++) {
+		band_offset[i + 1] = band_offset[i] + static_cast<uint32_t>(bands[i].runs.size());
+	}
+	uint32_t run_count = band_offset[band_count];
+	if (run_count == 0) return; // empty board
+
+	std::vector<uint32_t> parent(run_count);
+	std::vector<const Run*> runs(run_count);
+	for (int i = 0; i < band_count; i++) {
+		pool.submit([&, i]() {
+			Band& band = bands[i];
+			for (uint32_t k = 0; k < band.runs.size(); k++) {
+				parent[band_offset[i] + k] = band_offset[i] + band.parent[k];
+				runs[band_offset[i] + k] = &band.runs[k];
+			}
+		});
+	}
+	pool.wait();
+
+	// stitch neighbouring bands together, only their touching rows need a look
+	for (int i = 1; i < band_count; i++) {
+		const Band& above = bands[i - 1];
+		const Band& below = bands[i];
+		uint32_t a = above.row_begin[above.last_row - above.first_row - 1], a_end = above.row_begin.back();
+		uint32_t b = below.row_begin[0], b_end = below.row_begin[1];
+
+		while (a < a_end && b < b_end) {
+			const Run& top = above.runs[a];
+			const Run& bottom = below.runs[b];
+			if (top.end < bottom.start) {
+				a++;
+			} else if (bottom.end < top.start) {
+				b++;
+			} else {
+				unite(parent, band_offset[i - 1] + a, band_offset[i] + b);
+				if (top.end < bottom.end) a++; else b++;
+			}
+		}
+	}
+
+	// number the components and bucket runs by component
+	std::vector<uint32_t> component(run_count);
+	uint32_t component_count = 0;
+	for (uint32_t k = 0; k < run_count; k++) {
+		uint32_t root = find(parent, k);
+		component[k] = (root == k) ? component_count++ : component[root]; // a root always comes before the runs below it
+	}
+
+	std::vector<uint32_t> component_begin(component_count + 1, 0);
+	for (uint32_t k = 0; k < run_count; k++) {
+		component_begin[component[k] + 1]++;
+	}
+	for (uint32_t c = 0; c < component_count; c++) {
+		component_begin[c + 1] += component_begin[c];
+	}
+
+	std::vector<const Run*> sorted_runs(run_count);
+	{
+		std::vector<uint32_t> cursor(component_begin.begin(), component_begin.end() - 1);
+		for (uint32_t k = 0; k < run_count; k++) {
+			sorted_runs[cursor[component[k]]++] = runs[k];
+		}
+	}
+
+	// classify components in chunks, each chunk counts into its own table
+	size_t chunk_count = std::min<size_t>(component_count, static_cast<size_t>(this->thread_count) * 8);
+	std::vector<std::unordered_map<uint64_t, Entry>> tables(chunk_count);
+	for (size_t i = 0; i < chunk_count; i++) {
+		size_t first = component_count * i / chunk_count;
+		size_t last = component_count * (i + 1) / chunk_count;
+		pool.submit([this, &sorted_runs, &component_begin, &tables, first, last, i]() {
+			this->classify(sorted_runs, component_begin, first, last, tables[i]);
+		});
+	}
+	pool.wait();
+
+	std::unordered_map<uint64_t, Entry> merged;
+	for (auto& table : tables) {
+		for (auto& item : table) {
+			auto inserted = merged.emplace(item.first, item.second);
+			if (!inserted.second) {
+				inserted.first->second.count += item.second.count;
+			}
+		}
+	}
+
+	const auto& known = knownObjects();
+	for (auto& item : merged) {
+		auto name = known.find(item.first);
+		if (name != known.end()) {
+			item.second.name = name->second;
+		}
+		this->entries.push_back(std::move(item.second));
+	}
+
+	std::sort(this->entries.begin(), this->entries.end(), [](const Entry& a, const Entry& b) {
+		if (a.count != b.count) return a.count > b.count;
+		if (a.population != b.population) return a.population < b.population;
+		return a.hash < b.hash;
+	}); // most common first, ties in a stable order
+
+	this->object_count = component_count;
+}
+
+const std::vector<Census::Entry>& Census::getEntries() const {
+	return this->entries;
+}
+
+uint64_t Census::getObjectCount() const {
+	return this->object_count;
+}
+
+void Census::write(std::ostream& out) const {
+	out << "count,name,population,width,height,hash,pattern" << '\n';
+	for (auto& entry : this->entries) {
+		out << entry.count << ',' << entry.name << ',' << entry.population << ',' << entry.width << ','
+			<< entry.height << ',' << entry.hash << ',' << entry.pattern << '\n';
+	}
+	out.flush();
+}
+
+void Census::labelBand(Band& band, const std::vector<uint64_t>& packed, int width) const {
+	int words_per_row = (width + 63) / 64;
+	band.row_begin.reserve(band.last_row - band.first_row + 1);
+
+	for (int y = band.first_row; y < band.last_row; y++) {
+		band.row_begin.push_back(static_cast<uint32_t>(band.runs.size()));
+		const uint64_t* row = packed.data() + static_cast<size_t>(y) * words_per_row;
+
+		bool open = false; // a run continues from the previous word
+		int start = 0;
+		for (int k = 0; k < words_per_row; k++) {
+			uint64_t word = row[k];
+			int base = k * 64;
+
+			if (open) {
+				if (~word == 0) continue; // the run covers the whole word
+				int end = BitGrid::countTrailingZeros(~word);
+				band.runs.push_back({y, start, base + end});
+				open = false;
+				word &= ~uint64_t(0) << end;
+			} // close the run carried over from the previous word
+
+			while (word) {
+				int first = BitGrid::countTrailingZeros(word);
+				uint64_t gaps = ~word & (~uint64_t(0) << first);
+				if (gaps == 0) {
+					open = true;
+					start = base + first;
+					break;
+				} // the run reaches the end of the word
+
+				int end = BitGrid::countTrailingZeros(gaps);
+				band.runs.push_back({y, base + first, base + end});
+				word &= ~uint64_t(0) << end;
+			}
+		}
+
+		if (open) {
+			band.runs.push_back({y, start, width});
+		} // padding bits are never set, so an open run ends at the edge
+	}
+	band.row_begin.push_back(static_cast<uint32_t>(band.runs.size()));
+
+	band.parent.resize(band.runs.size());
+	for (uint32_t k = 0; k < band.parent.size(); k++) {
+		band.parent[k] = k;
+	}
+
+	for (int r = 1; r < band.last_row - band.first_row; r++) {
+		uint32_t a = band.row_begin[r - 1], a_end = band.row_begin[r];
+		uint32_t b = band.row_begin[r], b_end = band.row_begin[r + 1];
+
+		while (a < a_end && b < b_end) {
+			const Run& top = band.runs[a];
+			const Run& bottom = band.runs[b];
+			if (top.end < bottom.start) {
+				a++;
+			} else if (bottom.end < top.start) {
+				b++;
+			} else {
+				unite(band.parent, a, b); // runs touch or overlap diagonally
+				if (top.end < bottom.end) a++; else b++;
+			}
+		}
+	} // runs in neighbouring rows are sorted, so one sweep finds every touching pair
+}
+
+void Census::classify(const std::vector<const Run*>& runs, const std::vector<uint32_t>& component_begin, size_t first, size_t last, std::unordered_map<uint64_t, Entry>& table) const {
+	std::vector<std::pair<int, int>> cells; // reused between components
+
+	for (size_t c = first; c < last; c++) {
+		cells.clear();
+		for (uint32_t k = component_begin[c]; k < component_begin[c + 1]; k++) {
+			const Run* run = runs[k];
+			for (int x = run->start; x < run->end; x++) {
+				cells.emplace_back(x, run->y);
+			}
+		}
+
+		Entry entry;
+		uint64_t hash = canonicalize(cells, entry, false);
+		auto found = table.find(hash);
+		if (found != table.end()) {
+			found->second.count++;
+			continue;
+		} // seen this shape before, skip building its pattern
+
+		canonicalize(cells, entry, true);
+		entry.count = 1;
+		table.emplace(hash, std::move(entry));
+	}
+}
+
+uint64_t Census::canonicalize(std::vector<std::pair<int, int>>& cells, Entry& entry, bool with_pattern) {
+	int min_x = cells.front().first, max_x = min_x;
+	int min_y = cells.front().second, max_y = min_y;
+	for (auto& cell : cells) {
+		min_x = std::min(min_x, cell.first);
+		max_x = std::max(max_x, cell.first);
+		min_y = std::min(min_y, cell.second);
+		max_y = std::max(max_y, cell.second);
+	}
+	int width = max_x - min_x + 1, height = max_y - min_y + 1;
+
+	// try all eight rotations and reflections, keep the smallest as the canonical one
+	std::vector<uint64_t> best, candidate;
+	int best_width = 0, best_height = 0;
+	for (int transform = 0; transform < 8; transform++) {
+		bool flip_x = transform & 1, flip_y = transform & 2, swap = transform & 4;
+		int out_width = swap ? height : width, out_height = swap ? width : height;
+		if (!best.empty() && (out_width > best_width || (out_width == best_width && out_height > best_height))) continue; // can't beat the best
+
+		candidate.clear();
+		for (auto& cell : cells) {
+			int x = cell.first - min_x, y = cell.second - min_y;
+			if (flip_x) x = width - 1 - x;
+			if (flip_y) y = height - 1 - y;
+			if (swap) std::swap(x, y);
+			candidate.push_back((static_cast<uint64_t>(y) << 32) | static_cast<uint32_t>(x));
+		}
+		std::sort(candidate.begin(), candidate.end());
+
+		if (best.empty() || out_width < best_width || out_height < best_height || candidate < best) {
+			std::swap(best, candidate);
+			best_width = out_width;
+			best_height = out_height;
+		}
+	}
+
+	uint64_t hash = (static_cast<uint64_t>(best_width) << 32) | static_cast<uint32_t>(best_height);
+	for (uint64_t cell : best) {
+		hash ^= cell + 0x9E3779B97F4A7C15ull + (hash << 6) + (hash >> 2);
+	}
+	hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ull;
+	hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBull;
+	hash ^= hash >> 31;
+
+	entry.hash = hash;
+	entry.population = static_cast<int>(best.size());
+	entry.width = best_width;
+	entry.height = best_height;
+
+	if (with_pattern && best_width <= MAX_PATTERN_SIZE && best_height <= MAX_PATTERN_SIZE) {
+		std::vector<std::string> rows(best_height, std::string(best_width, '.'));
+		for (uint64_t cell : best) {
+			rows[cell >> 32][cell & 0xFFFFFFFF] = 'O';
+		}
+
+		entry.pattern.clear();
+		for (int y = 0; y < best_height; y++) {
+			if (y > 0) entry.pattern += '$';
+			entry.pattern += rows[y];
+		}
+	}
+
+	return hash;
+}
+
+uint32_t Census::find(std::vector<uint32_t>& parent, uint32_t index) {
+	while (parent[index] != index) {
+		parent[index] = parent[parent[index]]; // path halving
+		index = parent[index];
+	}
+	return index;
+}
+
+void Census::unite(std::vector<uint32_t>& parent, uint32_t a, uint32_t b) {
+	a = find(parent, a);
+	b = find(parent, b);
+	if (a == b) return;
+	if (a < b) parent[b] = a; else parent[a] = b; // the smaller index stays the root so roots come first in scan order
+}
+
+const std::unordered_map<uint64_t, std::string>& Census::knownObjects() {
+	static const std::unordered_map<uint64_t, std::string> known = []() {
+		const std::pair<const char*, const char*> objects[] = {
+			{"block", "OO$OO"},
+			{"blinker", "OOO"},
+			{"beehive", ".OO.$O..O$.OO."},
+			{"loaf", ".OO.$O..O$.O.O$..O."},
+			{"boat", "OO.$O.O$.O."},
+			{"ship", "OO.$O.O$.OO"},
+			{"tub", ".O.$O.O$.O."},
+			{"pond", ".OO.$O..O$O..O$.OO."},
+			{"long boat", "OO..$O.O.$.O.O$..O."},
+			{"barge", ".O..$O.O.$.O.O$..O."},
+			{"mango", ".OO..$O..O.$.O..O$..OO."},
+			{"toad", ".OOO$OOO."},
+			{"beacon", "OO..$OO..$..OO$..OO"},
+			{"glider", ".O.$..O$OOO"},
+			{"glider", "O.O$.OO$.O."},
+			{"lightweight spaceship", ".O..O$O....$O...O$OOOO."}
+		};
+
+		std::unordered_map<uint64_t, std::string> table;
+		for (auto& object : objects) {
+			std::vector<std::pair<int, int>> cells;
+			int x = 0, y = 0;
+			for (const char* c = object.second; *c; c++) {
+				if (*c == '$') {
+					x = 0;
+					y++;
+					continue;
+				}
+				if (*c == 'O') cells.emplace_back(x, y);
+				x++;
+			}
+
+			Entry entry;
+			table.emplace(canonicalize(cells, entry, false), object.first);
+		}
+		return table;
+	}();
+
+	return known;
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Universe;
+
+// splits a board into 8-connected objects and counts them by shape, ignoring rotation and reflection
+class Census {
+public:
+	struct Entry {
+		uint64_t hash = 0; // hash of the canonical orientation
+		std::string name; // empty for shapes not in the known object table
+		uint64_t count = 0;
+		int population = 0;
+		int width = 0; // size of the canonical orientation
+		int height = 0;
+		std::string pattern; // rows of '.' and 'O' separated by '$', empty for very large objects
+	};
+
+	explicit Census(unsigned int thread_count = 0); // 0 uses every hardware thread
+
+	void run(const Universe& universe);
+	void run(const std::vector<uint64_t>& packed, int width, int height); // rows of (width + 63) / 64 words, bit i of a word is column i
+	const std::vector<Entry>& getEntries() const; // most common first
+	uint64_t getObjectCount() const;
+	void write(std::ostream& out) const; // csv frequency table
+
+private:
+	struct Run {
+		int y;
+		int start;
+		int end; // exclusive
+	};
+
+	struct Band {
+		int first_row;
+		int last_row; // exclusive
+		std::vector<Run> runs;
+		std::vector<uint32_t> row_begin; // index of each row's first run, plus one past the end
+		std::vector<uint32_t> parent; // union-find over runs, local indices
+	};
+
+	// ---- methods ----
+	void labelBand(Band& band, const std::vector<uint64_t>& packed, int width) const;
+	void classify(const std::vector<const Run*>& runs, const std::vector<uint32_t>& component_begin, size_t first, size_t last, std::unordered_map<uint64_t, Entry>& table) const;
+	static uint64_t canonicalize(std::vector<std::pair<int, int>>& cells, Entry& entry, bool with_pattern);
+	static uint32_t find(std::vector<uint32_t>& parent, uint32_t index);
+	static void unite(std::vector<uint32_t>& parent, uint32_t a, uint32_t b);
+	static const std::unordered_map<uint64_t, std::string>& knownObjects();
+
+	// ---- attributes ----
+	unsigned int thread_count;
+	std::vector<Entry> entries;
+	uint64_t object_count = 0;
+
+	static constexpr int MIN_BAND_ROWS = 32;
+	static constexpr int MAX_PATTERN_SIZE = 64; // larger objects are counted without a pattern string
+};
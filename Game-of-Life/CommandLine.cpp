@@ -0,0 +1,43 @@
+#include "CommandLine.h"
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+bool CommandLine::parseOptions(int argc, char* argv[], const Handler& handle) {
+	for (int i = 2; i < argc; i++) {
+		std::string option = argv[i];
+		if (i + 1 >= argc) {
+			std::cerr << "ERROR: Missing value for " << option << std::endl;
+			return false;
+		} // every option takes a value
+
+		std::string value = argv[++i];
+		try {
+			if (!handle(option, value)) {
+				std::cerr << "ERROR: Unknown option " << option << std::endl;
+				return false;
+			}
+		} catch (const std::exception&) {
+			std::cerr << "ERROR: Invalid value for " << option << ": " << value << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+int64_t CommandLine::toInteger(const std::string& value, int64_t min, int64_t max) {
+	size_t length = 0;
+	long long number = std::stoll(value, &length);
+	if (length != value.size()) {
+		throw std::invalid_argument(value);
+	} // "5x" isn't 5
+	if (number < min || number > max) {
+		throw std::out_of_range(value);
+	}
+	return number;
+}
+
+int64_t CommandLine::getMaxThreads() {
+	return THREADS_PER_CORE * std::max(1u, std::thread::hardware_concurrency());
+}
@@ -0,0 +1,17 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <string>
+
+// "--name value" options of the headless modes, everything after the mode's own flag
+// integers are range checked, so "-1" for a count is an error instead of wrapping to a huge unsigned value
+class CommandLine {
+public:
+	using Handler = std::function<bool(const std::string& option, const std::string& value)>; // false for an unknown option, throws for a bad value
+
+	static bool parseOptions(int argc, char* argv[], const Handler& handle); // from argv[2] on, false with an error printed for a missing value, an unknown option or a bad value
+	static int64_t toInteger(const std::string& value, int64_t min, int64_t max); // whole decimal number in [min, max], throws std::invalid_argument or std::out_of_range otherwise
+	static int64_t getMaxThreads(); // cap for thread and process counts
+
+	static constexpr int64_t THREADS_PER_CORE = 4; // oversubscribing further only adds switching
+};
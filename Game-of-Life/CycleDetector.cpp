@@ -0,0 +1,44 @@
+#include "CycleDetector.h"
+#include <algorithm>
+
+CycleDetector::CycleDetector(size_t window) {
+	this->window = std::max<size_t>(window, 1);
+}
+
+const CycleDetector::Result& CycleDetector::update(uint64_t generation, uint64_t hash, int64_t population) {
+	auto it = this->seen.find(hash);
+	if (!this->result.found && it != this->seen.end() && it->second.population == population && it->second.generation < generation) {
+		this->result.found = true;
+		this->result.period = generation - it->second.generation;
+		this->result.start_generation = it->second.generation;
+	} // same board seen before, the generations in between repeat forever
+
+	this->seen[hash] = Entry{generation, population};
+	this->order.emplace_back(hash, generation);
+
+	while (this->order.size() > this->window) {
+		auto [old_hash, old_generation] = this->order.front();
+		this->order.pop_front();
+
+		auto old = this->seen.find(old_hash);
+		if (old != this->seen.end() && old->second.generation == old_generation) {
+			this->seen.erase(old);
+		} // only erase if the hash wasn't seen again since
+	} // forget generations that fell out of the window
+
+	return this->result;
+}
+
+void CycleDetector::clear() {
+	this->seen.clear();
+	this->order.clear();
+	this->result = Result{};
+}
+
+const CycleDetector::Result& CycleDetector::getResult() const {
+	return this->result;
+}
+
+void CycleDetector::setWindow(size_t window) {
+	this->window = std::max<size_t>(window, 1);
+}
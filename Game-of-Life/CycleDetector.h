@@ -0,0 +1,33 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <deque>
+#include <unordered_map>
+
+// detects still lifes and oscillators by remembering the hashes of recent generations
+class CycleDetector {
+public:
+	struct Result {
+		bool found = false;
+		uint64_t period = 0; // 1 for a still life
+		uint64_t start_generation = 0; // first generation of the repeating sequence
+	};
+
+	CycleDetector(size_t window = 1024);
+
+	const Result& update(uint64_t generation, uint64_t hash, int64_t population); // call once per generation, in order
+	void clear(); // call whenever the board changes by anything other than a step
+	const Result& getResult() const;
+	void setWindow(size_t window); // longest period that can be detected
+
+private:
+	struct Entry {
+		uint64_t generation;
+		int64_t population; // cheap second check against hash collisions
+	};
+
+	std::unordered_map<uint64_t, Entry> seen; // hash -> latest generation with that hash
+	std::deque<std::pair<uint64_t, uint64_t>> order; // (hash, generation) oldest first, for eviction
+	size_t window;
+	Result result;
+};
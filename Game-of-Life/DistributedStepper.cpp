@@ -0,0 +1,368 @@
+#include "DistributedStepper.h"
+#include "CommandLine.h"
+#include "SharedMemoryTransport.h"
+#include "TileStepper.h"
+#include "Universe.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <new>
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+#include <iostream>
+
+DistributedStepper::DistributedStepper(const Config& config) {
+	this->config = config;
+}
+
+bool DistributedStepper::partition() {
+	this->regions.clear();
+	int words = (this->config.width + 63) / 64;
+
+	int64_t best_halo = -1;
+	for (int columns = 1; columns <= this->config.processes; columns++) {
+		if (this->config.processes % columns != 0) continue;
+		int rows = this->config.processes / columns;
+		if (columns > words || rows > this->config.height) continue;
+
+		int64_t halo = static_cast<int64_t>(columns - 1) * this->config.height + static_cast<int64_t>(rows - 1) * this->config.width;
+		if (best_halo < 0 || halo < best_halo) {
+			best_halo = halo;
+			this->columns = columns;
+			this->rows = rows;
+		}
+	} // cells crossing a region border each generation, fewer means less to send
+	if (best_halo < 0) return false;
+
+	for (int row = 0; row < this->rows; row++) {
+		for (int column = 0; column < this->columns; column++) {
+			Region region;
+			region.column = column;
+			region.row = row;
+			region.first_row = static_cast<int>(static_cast<int64_t>(this->config.height) * row / this->rows);
+			region.rows = static_cast<int>(static_cast<int64_t>(this->config.height) * (row + 1) / this->rows) - region.first_row;
+			region.first_word = static_cast<int>(static_cast<int64_t>(words) * column / this->columns);
+			region.words = static_cast<int>(static_cast<int64_t>(words) * (column + 1) / this->columns) - region.first_word;
+			this->regions.push_back(region);
+		}
+	}
+	return true;
+}
+
+bool DistributedStepper::run(const std::vector<uint64_t>& packed, std::vector<uint64_t>& result, GenerationStats& stats) {
+#if defined(__unix__) || defined(__APPLE__)
+	if (this->regions.empty() && !this->partition()) {
+		std::cerr << "ERROR: A " << this->config.width << " x " << this->config.height << " board can't be split across " << this->config.processes << " processes" << std::endl;
+		return false;
+	}
+
+	int words_per_row = (this->config.width + 63) / 64;
+	size_t count = this->regions.size();
+	size_t capacity = static_cast<size_t>(std::max(this->config.ring_capacity, 1));
+
+	// segment layout: control block, one slot per worker, every worker's incoming rings, every worker's region
+	size_t bytes = sizeof(Control) + count * sizeof(WorkerSlot);
+	std::vector<size_t> ring_offsets(count * 4, 0);
+	std::vector<size_t> ring_words(count * 4, 0);
+	for (size_t i = 0; i < count; i++) {
+		const Region& region = this->regions[i];
+		for (int direction = 0; direction < 4; direction++) {
+			if (this->getNeighbour(static_cast<int>(i), static_cast<HaloTransport::Direction>(direction)) < 0) continue;
+
+			size_t message_words = direction == HaloTransport::Up || direction == HaloTransport::Down
+				? static_cast<size_t>(region.words) + 2 // a row with its corner cells
+				: (static_cast<size_t>(region.rows) + 63) / 64; // a column, one bit per row
+			ring_offsets[i * 4 + direction] = bytes;
+			ring_words[i * 4 + direction] = message_words;
+			bytes += SharedMemoryTransport::Ring::getBytes(message_words, capacity);
+		}
+	}
+	std::vector<size_t> region_offsets(count, 0);
+	for (size_t i = 0; i < count; i++) {
+		region_offsets[i] = bytes;
+		bytes += (static_cast<size_t>(this->regions[i].rows) * this->regions[i].words * sizeof(uint64_t) + 63) / 64 * 64;
+	}
+
+	char* segment = static_cast<char*>(SharedMemoryTransport::mapSegment(bytes));
+	if (!segment) return false;
+
+	Control* control = new (segment) Control;
+	control->abort.store(0);
+	WorkerSlot* slots = reinterpret_cast<WorkerSlot*>(segment + sizeof(Control));
+	std::vector<SharedMemoryTransport::Ring*> rings(count * 4, nullptr);
+	for (size_t i = 0; i < count; i++) {
+		new (&slots[i]) WorkerSlot;
+		slots[i].state.store(0);
+
+		for (int direction = 0; direction < 4; direction++) {
+			if (ring_offsets[i * 4 + direction] == 0) continue;
+			rings[i * 4 + direction] = SharedMemoryTransport::Ring::create(segment + ring_offsets[i * 4 + direction], ring_words[i * 4 + direction], capacity);
+		} // ring i * 4 + d carries messages to worker i from its neighbour in direction d
+
+		const Region& region = this->regions[i];
+		uint64_t* words = reinterpret_cast<uint64_t*>(segment + region_offsets[i]);
+		for (int y = 0; y < region.rows; y++) {
+			const uint64_t* source = packed.data() + static_cast<size_t>(region.first_row + y) * words_per_row + region.first_word;
+			std::copy(source, source + region.words, words + static_cast<size_t>(y) * region.words);
+		}
+	}
+
+	std::cout.flush(); // or the workers would print whatever is still buffered again
+	std::vector<pid_t> workers;
+	for (size_t i = 0; i < count; i++) {
+		pid_t pid = fork();
+		if (pid == 0) {
+			SharedMemoryTransport::Ring* incoming[4];
+			SharedMemoryTransport::Ring* outgoing[4];
+			for (int direction = 0; direction < 4; direction++) {
+				int neighbour = this->getNeighbour(static_cast<int>(i), static_cast<HaloTransport::Direction>(direction));
+				incoming[direction] = rings[i * 4 + direction];
+				outgoing[direction] = neighbour < 0 ? nullptr : rings[static_cast<size_t>(neighbour) * 4 + HaloTransport::getOpposite(static_cast<HaloTransport::Direction>(direction))];
+			} // what this worker sends up is what its upper neighbour receives from below
+
+			SharedMemoryTransport transport(incoming, outgoing, &control->abort);
+			GenerationStats region_stats;
+			bool done = this->stepRegion(this->regions[i], transport, reinterpret_cast<uint64_t*>(segment + region_offsets[i]), region_stats);
+			slots[i].stats = region_stats;
+			slots[i].state.store(done ? 1 : -1, std::memory_order_release);
+			_exit(done ? 0 : 1); // skip destructors, they belong to the coordinator's copy of everything
+		} // worker
+
+		if (pid < 0) {
+			std::cerr << "ERROR: Couldn't start worker process " << i << std::endl;
+			control->abort.store(1);
+			break;
+		}
+		workers.push_back(pid);
+	}
+
+	bool success = workers.size() == count;
+	for (size_t finished = 0; finished < workers.size(); finished++) {
+		int status = 0;
+		pid_t pid = wait(&status);
+		if (pid < 0) break;
+
+		if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+			success = false;
+			control->abort.store(1); // nobody would ever send its halo again
+		}
+	}
+
+	for (size_t i = 0; i < count && success; i++) {
+		if (slots[i].state.load(std::memory_order_acquire) != 1) {
+			success = false;
+		}
+	}
+	if (!success) {
+		std::cerr << "ERROR: A worker process failed, the distributed run was abandoned" << std::endl;
+		SharedMemoryTransport::unmapSegment(segment, bytes);
+		return false;
+	}
+
+	result.assign(static_cast<size_t>(this->config.height) * words_per_row, 0);
+	stats = GenerationStats();
+	for (size_t i = 0; i < count; i++) {
+		const Region& region = this->regions[i];
+		const uint64_t* words = reinterpret_cast<const uint64_t*>(segment + region_offsets[i]);
+		for (int y = 0; y < region.rows; y++) {
+			std::copy(words + static_cast<size_t>(y) * region.words, words + static_cast<size_t>(y + 1) * region.words,
+				result.begin() + static_cast<size_t>(region.first_row + y) * words_per_row + region.first_word);
+		}
+		stats.merge(slots[i].stats);
+	}
+	stats.generation = this->config.generations;
+
+	SharedMemoryTransport::unmapSegment(segment, bytes);
+	return true;
+#else
+	(void)packed;
+	(void)result;
+	(void)stats;
+	std::cerr << "ERROR: Distributed stepping needs fork and posix shared memory, it isn't available on this platform" << std::endl;
+	return false;
+#endif
+}
+
+const std::vector<DistributedStepper::Region>& DistributedStepper::getRegions() const {
+	return this->regions;
+}
+
+int DistributedStepper::getColumns() const {
+	return this->columns;
+}
+
+int DistributedStepper::getRows() const {
+	return this->rows;
+}
+
+int DistributedStepper::getNeighbour(int index, HaloTransport::Direction direction) const {
+	int column = this->regions[index].column, row = this->regions[index].row;
+	switch (direction) {
+	case HaloTransport::Up: row--; break;
+	case HaloTransport::Down: row++; break;
+	case HaloTransport::Left: column--; break;
+	case HaloTransport::Right: column++; break;
+	}
+
+	if (column < 0 || column >= this->columns || row < 0 || row >= this->rows) return -1; // cells past the board are dead
+	return row * this->columns + column;
+}
+
+bool DistributedStepper::stepRegion(const Region& region, HaloTransport& transport, uint64_t* words, GenerationStats& stats) const {
+	// the region with a one word border all around, so its words line up with the board's and the border holds the halo
+	int local_words = region.words + 2;
+	BitGrid current(64 * local_words, region.rows + 2);
+	BitGrid next(64 * local_words, region.rows + 2);
+	for (int y = 0; y < region.rows; y++) {
+		std::copy(words + static_cast<size_t>(y) * region.words, words + static_cast<size_t>(y + 1) * region.words, current.row(y + 1) + 1);
+	}
+
+	bool last_column = region.column == this->columns - 1;
+	uint64_t last_mask = this->config.width % 64 == 0 ? ~uint64_t(0) : (uint64_t(1) << (this->config.width % 64)) - 1;
+	std::vector<uint64_t> column;
+
+	for (uint64_t generation = 1; generation <= this->config.generations; generation++) {
+		if (!DistributedStepper::exchange(current, region, transport, column)) {
+			return false;
+		}
+
+		bool last_generation = generation == this->config.generations;
+		for (int y = 1; y <= region.rows; y++) {
+			uint64_t* out = next.row(y);
+			BitGrid::stepRow(current.row(y - 1), current.row(y), current.row(y + 1), out, local_words, ~uint64_t(0));
+			out[0] = 0;
+			out[local_words - 1] = 0; // the border is refilled by the next exchange, or stays dead at the board's edge
+			if (last_column) out[region.words] &= last_mask;
+
+			if (last_generation) {
+				TileStepper::accumulateRow(region.first_row + y - 1, region.first_word, current.row(y) + 1, out + 1, region.words, stats);
+			}
+		}
+		std::swap(current, next);
+	}
+
+	for (int y = 0; y < region.rows; y++) {
+		std::copy(current.row(y + 1) + 1, current.row(y + 1) + 1 + region.words, words + static_cast<size_t>(y) * region.words);
+	}
+	return true;
+}
+
+bool DistributedStepper::exchange(BitGrid& local, const Region& region, HaloTransport& transport, std::vector<uint64_t>& column) {
+	size_t column_words = (static_cast<size_t>(region.rows) + 63) / 64;
+	int last = region.words; // local index of the region's last word, word 0 and last + 1 are the border
+
+	// columns first, one bit per row
+	for (HaloTransport::Direction direction : {HaloTransport::Left, HaloTransport::Right}) {
+		if (!transport.hasNeighbour(direction)) continue;
+
+		column.assign(column_words, 0);
+		for (int y = 0; y < region.rows; y++) {
+			uint64_t bit = direction == HaloTransport::Left ? local.row(y + 1)[1] & 1 : local.row(y + 1)[last] >> 63;
+			column[y / 64] |= bit << (y % 64);
+		}
+		if (!transport.send(direction, column.data(), column_words)) return false;
+	}
+
+	for (HaloTransport::Direction direction : {HaloTransport::Left, HaloTransport::Right}) {
+		if (!transport.hasNeighbour(direction)) continue;
+
+		column.resize(column_words);
+		if (!transport.receive(direction, column.data(), column_words)) return false;
+		for (int y = 0; y < region.rows; y++) {
+			uint64_t bit = column[y / 64] >> (y % 64) & 1;
+			if (direction == HaloTransport::Left) local.row(y + 1)[0] = bit << 63;
+			else local.row(y + 1)[last + 1] = bit;
+		}
+	}
+
+	// then rows, which now carry the cells diagonal neighbours sent into the border
+	if (transport.hasNeighbour(HaloTransport::Up) && !transport.send(HaloTransport::Up, local.row(1), last + 2)) return false;
+	if (transport.hasNeighbour(HaloTransport::Down) && !transport.send(HaloTransport::Down, local.row(region.rows), last + 2)) return false;
+	if (transport.hasNeighbour(HaloTransport::Up) && !transport.receive(HaloTransport::Up, local.row(0), last + 2)) return false;
+	if (transport.hasNeighbour(HaloTransport::Down) && !transport.receive(HaloTransport::Down, local.row(region.rows + 1), last + 2)) return false;
+	return true;
+}
+
+bool DistributedStepper::parseArguments(int argc, char* argv[], Config& config) {
+	bool parsed = CommandLine::parseOptions(argc, argv, [&config](const std::string& option, const std::string& value) {
+		if (option == "--processes") config.processes = static_cast<int>(CommandLine::toInteger(value, 1, CommandLine::getMaxThreads())); // each one is forked
+		else if (option == "--width") config.width = static_cast<int>(CommandLine::toInteger(value, 1, INT32_MAX));
+		else if (option == "--height") config.height = static_cast<int>(CommandLine::toInteger(value, 1, INT32_MAX));
+		else if (option == "--percent") config.percent = static_cast<int>(CommandLine::toInteger(value, 0, 100));
+		else if (option == "--seed") config.seed = static_cast<unsigned int>(CommandLine::toInteger(value, 0, UINT32_MAX));
+		else if (option == "--generations") config.generations = static_cast<uint64_t>(CommandLine::toInteger(value, 1, INT64_MAX));
+		else if (option == "--ring") config.ring_capacity = static_cast<int>(CommandLine::toInteger(value, 1, 1024)); // borders held per neighbour, in shared memory
+		else if (option == "--verify") config.verify = CommandLine::toInteger(value, 0, 1) != 0;
+		else if (option == "--load") config.load_file = value;
+		else return false;
+		return true;
+	});
+	if (!parsed) return false;
+
+	if (config.width <= 0 || config.height <= 0 || config.percent < 0 || config.percent > 100 || config.generations == 0
+		|| config.processes <= 0 || config.ring_capacity <= 0) {
+		std::cerr << "ERROR: Invalid distributed board, generation count or process count" << std::endl;
+		return false;
+	} // exit if the run can't be set up
+
+	return true;
+}
+
+int DistributedStepper::runFromArguments(int argc, char* argv[]) {
+	Config config;
+	if (!DistributedStepper::parseArguments(argc, argv, config)) {
+		return 1;
+	}
+
+	Universe universe(5, 5, 0);
+	universe.setHistoryEnabled(false);
+	universe.setThreadCount(1); // no stepping threads yet when the workers are forked
+	if (config.load_file.empty()) {
+		universe.setMemoryBudget(std::max(universe.getMemoryBudget(), universe.estimateMemory(config.width, config.height)));
+		if (!universe.initialize(config.width, config.height, config.percent, config.seed)) {
+			return 1;
+		}
+	} else if (!universe.loadFromFile(config.load_file)) {
+		return 1;
+	}
+
+	std::vector<uint64_t> packed, result;
+	universe.copyPackedGrid(packed, config.width, config.height); // a loaded pattern brings its own size
+
+	DistributedStepper stepper(config);
+	if (!stepper.partition()) {
+		std::cerr << "ERROR: A " << config.width << " x " << config.height << " board can't be split across " << config.processes << " processes" << std::endl;
+		return 1;
+	}
+	std::cout << config.width << " x " << config.height << " board on " << config.processes << " processes, "
+		<< stepper.getColumns() << " x " << stepper.getRows() << " regions" << std::endl;
+
+	GenerationStats stats;
+	auto start = std::chrono::steady_clock::now();
+	if (!stepper.run(packed, result, stats)) {
+		return 1;
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	std::cout << config.generations << " generations in " << seconds << " s ("
+		<< static_cast<double>(config.width) * config.height * config.generations / std::max(seconds, 1e-9) / 1e9 << " Gcells/s), population "
+		<< stats.population << ", hash " << stats.hash << std::endl;
+
+	if (!config.verify) return 0;
+
+	universe.setThreadCount(0);
+	universe.step(config.generations, false);
+	std::vector<uint64_t> expected;
+	int width = 0, height = 0;
+	universe.copyPackedGrid(expected, width, height);
+	GenerationStats expected_stats = universe.getStats();
+
+	if (expected != result || expected_stats.hash != stats.hash || expected_stats.population != stats.population) {
+		std::cerr << "ERROR: Distributed result differs from a single process run (population " << expected_stats.population
+			<< ", hash " << expected_stats.hash << ")" << std::endl;
+		return 1;
+	}
+	std::cout << "matches a single process run" << std::endl;
+	return 0;
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "BitGrid.h"
+#include "GenerationStats.h"
+#include "HaloTransport.h"
+
+// steps a board split across several worker processes (domain decomposition)
+// the board is cut into a grid of regions and each worker steps its own, trading the one cell wide border with
+// the workers around it every generation through a halo transport; columns go first and rows carry the corners on
+// the coordinator picks the split, forks the workers on this machine and gathers their regions and stats at the end
+// workers only depend on HaloTransport, so spreading them over several machines means another transport and launcher
+class DistributedStepper {
+public:
+	struct Config {
+		int width = 4096;
+		int height = 4096;
+		int percent = 30;
+		unsigned int seed = 1;
+		uint64_t generations = 256;
+		int processes = 4;
+		int ring_capacity = 4; // generations a worker may run ahead of a neighbour
+		bool verify = true; // compare against a single process run
+		std::string load_file; // start from a pattern instead of a random board
+	};
+
+	struct Region {
+		int column, row; // position in the grid of regions
+		int first_row, rows;
+		int first_word, words; // regions are cut on word boundaries, only the last column has a partial word
+	};
+
+	DistributedStepper(const Config& config);
+
+	bool partition(); // choose the split with the least halo, false if the board is too small for the processes
+	bool run(const std::vector<uint64_t>& packed, std::vector<uint64_t>& result, GenerationStats& stats); // packed rows as from Universe::copyPackedGrid, result the same after the generations
+	const std::vector<Region>& getRegions() const;
+	int getColumns() const;
+	int getRows() const;
+
+	static bool parseArguments(int argc, char* argv[], Config& config); // --processes, --width, --height, --percent, --seed, --generations, --ring, --verify, --load
+	static int runFromArguments(int argc, char* argv[]); // entry point for --distributed, returns the process exit code
+
+private:
+	struct Control {
+		alignas(64) std::atomic<int> abort; // a worker failed, the rest give up instead of waiting for its halo
+	};
+
+	struct WorkerSlot {
+		alignas(64) std::atomic<int> state; // 0 running, 1 done, -1 gave up
+		GenerationStats stats; // of the region's final generation
+	};
+
+	// ---- methods ----
+	int getNeighbour(int index, HaloTransport::Direction direction) const; // -1 past the edge of the board
+	bool stepRegion(const Region& region, HaloTransport& transport, uint64_t* words, GenerationStats& stats) const; // what a worker process runs, words holds the region on the way in and out, false if the run was aborted
+	static bool exchange(BitGrid& local, const Region& region, HaloTransport& transport, std::vector<uint64_t>& column);
+
+	// ---- attributes ----
+	Config config;
+	int columns = 0;
+	int rows = 0;
+	std::vector<Region> regions; // row by row
+};
@@ -0,0 +1,37 @@
+#include "EditQueue.h"
+#include <algorithm>
+
+EditQueue::~EditQueue() {
+	Node* node = this->head.exchange(nullptr);
+	while (node) {
+		Node* next = node->next;
+		delete node;
+		node = next;
+	} // free batches that were never applied
+}
+
+void EditQueue::push(EditBatch batch) {
+	Node* node = new Node{std::move(batch), this->head.load(std::memory_order_relaxed)};
+
+	while (!this->head.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) {
+	} // retry until the node is linked in front of the current head
+}
+
+std::vector<EditBatch> EditQueue::drain() {
+	std::vector<EditBatch> batches;
+
+	Node* node = this->head.exchange(nullptr, std::memory_order_acquire); // detach the whole list at once
+	while (node) {
+		Node* next = node->next;
+		batches.push_back(std::move(node->batch));
+		delete node;
+		node = next;
+	}
+
+	std::reverse(batches.begin(), batches.end()); // list is newest first, apply in submission order
+	return batches;
+}
+
+bool EditQueue::empty() const {
+	return this->head.load(std::memory_order_acquire) == nullptr;
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <atomic>
+#include <vector>
+
+enum class CellState; // defined in Universe.h
+
+// a single cell change requested by the ui
+struct CellEdit {
+	int x;
+	int y;
+	CellState state;
+};
+
+// every cell touched by one user action (e.g. one brush stamp), applied together
+struct EditBatch {
+	std::vector<CellEdit> cells;
+};
+
+// lock-free multi-producer single-consumer queue of edit batches
+// producers push with a single compare-and-swap, the consumer takes the whole list at once
+class EditQueue {
+public:
+	EditQueue() = default;
+	~EditQueue();
+	EditQueue(const EditQueue&) = delete;
+	EditQueue& operator=(const EditQueue&) = delete;
+
+	void push(EditBatch batch); // safe from any thread
+	std::vector<EditBatch> drain(); // take all pending batches in submission order, one consumer at a time
+	bool empty() const;
+
+private:
+	struct Node {
+		EditBatch batch;
+		Node* next;
+	};
+
+	std::atomic<Node*> head{nullptr}; // most recently pushed batch
+};
@@ -0,0 +1,531 @@
+#include "EngineVerifier.h"
+#include "BitGrid.h"
+#include "CommandLine.h"
+#include "DistributedStepper.h"
+#include "TileStepper.h"
+#include "Universe.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+EngineVerifier::EngineVerifier(const Config& config) {
+	this->config = config;
+}
+
+bool EngineVerifier::verify() {
+	this->failures = 0;
+	std::vector<Board> corpus = this->buildCorpus();
+	std::vector<Engine> engines = this->buildEngines();
+
+	// the reference runs once per board, every engine is compared against the same answer
+	std::vector<Board> expected;
+	for (const Board& board : corpus) {
+		expected.push_back(EngineVerifier::reference(board, this->config.generations));
+	}
+
+	int engines_run = 0;
+	for (const Engine& engine : engines) {
+		if (!this->config.engine.empty() && engine.name.find(this->config.engine) == std::string::npos) continue;
+		engines_run++;
+
+		auto start = std::chrono::steady_clock::now();
+		int differ = 0, skipped = 0;
+		for (size_t i = 0; i < corpus.size(); i++) {
+			std::string difference;
+			Outcome outcome = this->compare(engine, corpus[i], expected[i], this->config.generations, &difference);
+			if (outcome == Outcome::Skipped) skipped++;
+			if (outcome != Outcome::Differs) continue;
+
+			differ++;
+			this->failures++;
+			std::cout << "FAIL " << engine.name << " on " << corpus[i].name << " after " << this->config.generations << " generations: " << difference << std::endl;
+			if (!this->config.minimize) continue;
+
+			uint64_t generations = this->config.generations;
+			Board reproducer = this->minimize(engine, corpus[i], generations);
+			int64_t population = EngineVerifier::describe(reproducer).population;
+			std::string path;
+			std::cout << "  minimized to " << reproducer.width << " x " << reproducer.height << " with " << population << " live cells, "
+				<< generations << " generations";
+			if (this->writeReproducer(reproducer, engine.name, path)) {
+				std::cout << ", saved to " << path;
+			}
+			std::cout << std::endl;
+		}
+
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		std::cout << engine.name << ": " << (differ == 0 ? "ok" : std::to_string(differ) + " of " + std::to_string(corpus.size()) + " boards differ");
+		if (skipped > 0) std::cout << ", " << skipped << " skipped";
+		std::cout << " (" << seconds << " s)" << std::endl;
+	}
+
+	std::cout << engines_run << " engines, " << corpus.size() << " boards, " << this->config.generations << " generations: "
+		<< (this->failures == 0 ? "all agree with nextGeneration" : std::to_string(this->failures) + " failures") << std::endl;
+	return this->failures == 0;
+}
+
+std::vector<EngineVerifier::Board> EngineVerifier::buildCorpus() const {
+	const std::vector<std::pair<std::string, std::vector<std::string>>> patterns = {
+		{"blinker", {"OOO"}},
+		{"glider", {".O.", "..O", "OOO"}},
+		{"lwss", {".O..O", "O....", "O...O", "OOOO."}},
+		{"r-pentomino", {".OO", "OO.", ".O."}},
+		{"acorn", {".O.....", "...O...", "OO..OOO"}},
+		{"diehard", {"......O.", "OO......", ".O...OOO"}},
+		{"gosper gun", {
+			"........................O...........",
+			"......................O.O...........",
+			"............OO......OO............OO",
+			"...........O...O....OO............OO",
+			"OO........O.....O...OO..............",
+			"OO........O...O.OO....O.O...........",
+			"..........O.....O.......O...........",
+			"............O...O...................",
+			".............OO.....................",
+		}},
+	};
+
+	std::vector<Board> corpus;
+	for (const auto& pattern : patterns) {
+		int width = static_cast<int>(pattern.second[0].size()), height = static_cast<int>(pattern.second.size());
+
+		Board centered = EngineVerifier::makeBoard(pattern.first + " centered", 64, 64);
+		EngineVerifier::stamp(centered, pattern.second, (64 - width) / 2, (64 - height) / 2);
+		corpus.push_back(centered);
+
+		Board corner = EngineVerifier::makeBoard(pattern.first + " in the top left corner", 67, 41);
+		EngineVerifier::stamp(corner, pattern.second, 0, 0);
+		corpus.push_back(corner);
+
+		Board far_corner = EngineVerifier::makeBoard(pattern.first + " in the bottom right corner", 67, 41);
+		EngineVerifier::stamp(far_corner, pattern.second, 67 - width, 41 - height);
+		corpus.push_back(far_corner);
+
+		Board boundary = EngineVerifier::makeBoard(pattern.first + " across a word boundary", 200, 120);
+		EngineVerifier::stamp(boundary, pattern.second, 62, 40);
+		corpus.push_back(boundary);
+	} // edges are where dead boundaries and word and tile seams can go wrong
+
+	Board empty = EngineVerifier::makeBoard("empty", 70, 70);
+	corpus.push_back(empty);
+
+	Board full = EngineVerifier::makeBoard("full", 100, 10);
+	for (int y = 0; y < full.height; y++) {
+		for (int x = 0; x < full.width; x++) {
+			EngineVerifier::setAlive(full, x, y, true);
+		}
+	}
+	corpus.push_back(full);
+
+	Board row = EngineVerifier::makeBoard("single row", 200, 1);
+	Board column = EngineVerifier::makeBoard("single column", 1, 150);
+	for (int i = 0; i < 150; i++) {
+		if (i % 3 != 2) {
+			EngineVerifier::setAlive(row, i, 0, true);
+			EngineVerifier::setAlive(column, 0, i, true);
+		}
+	}
+	corpus.push_back(row);
+	corpus.push_back(column);
+
+	// random soups of several sizes, none of them a whole number of words or tiles wide
+	const int sizes[][3] = {{37, 29, 40}, {64, 64, 35}, {150, 97, 30}, {300, 200, 25}};
+	for (const auto& size : sizes) {
+		for (int i = 0; i < this->config.seeds; i++) {
+			unsigned int seed = this->config.first_seed + i;
+			Universe universe(5, 5, 0);
+			universe.setHistoryEnabled(false);
+			universe.initialize(size[0], size[1], size[2], seed);
+
+			Board soup;
+			soup.name = "soup " + std::to_string(size[0]) + " x " + std::to_string(size[1]) + " seed " + std::to_string(seed);
+			universe.copyPackedGrid(soup.packed, soup.width, soup.height);
+			corpus.push_back(soup);
+		}
+	}
+
+	Universe universe(5, 5, 0);
+	universe.setHistoryEnabled(false);
+	universe.initialize(1100, 1000, 30, this->config.first_seed);
+	Board large;
+	large.name = "soup 1100 x 1000 seed " + std::to_string(this->config.first_seed);
+	universe.copyPackedGrid(large.packed, large.width, large.height);
+	corpus.push_back(large); // big enough for stepping to spread over threads
+	return corpus;
+}
+
+std::vector<EngineVerifier::Engine> EngineVerifier::buildEngines() const {
+	std::vector<Engine> engines;
+
+	engines.push_back({"cells", [](const Board& board, uint64_t generations, Board& result, GenerationStats& stats) {
+		// a byte per cell and a plain neighbour count, shares no code with the bit-parallel engines
+		int width = board.width, height = board.height;
+		std::vector<uint8_t> cells(static_cast<size_t>(width) * height), next(cells.size());
+		for (int y = 0; y < height; y++) {
+			for (int x = 0; x < width; x++) {
+				cells[static_cast<size_t>(y) * width + x] = EngineVerifier::isAlive(board, x, y);
+			}
+		}
+
+		for (uint64_t generation = 0; generation < generations; generation++) {
+			for (int y = 0; y < height; y++) {
+				for (int x = 0; x < width; x++) {
+					int neighbours = 0;
+					for (int dy = -1; dy <= 1; dy++) {
+						for (int dx = -1; dx <= 1; dx++) {
+							int nx = x + dx, ny = y + dy;
+							if ((dx != 0 || dy != 0) && nx >= 0 && nx < width && ny >= 0 && ny < height) {
+								neighbours += cells[static_cast<size_t>(ny) * width + nx];
+							}
+						}
+					}
+					uint8_t alive = cells[static_cast<size_t>(y) * width + x];
+					next[static_cast<size_t>(y) * width + x] = neighbours == 3 || (alive && neighbours == 2);
+				}
+			}
+			std::swap(cells, next);
+		}
+
+		result = EngineVerifier::makeBoard(board.name, width, height);
+		for (int y = 0; y < height; y++) {
+			for (int x = 0; x < width; x++) {
+				if (cells[static_cast<size_t>(y) * width + x]) EngineVerifier::setAlive(result, x, y, true);
+			}
+		}
+		stats = EngineVerifier::describe(result);
+		return true;
+	}});
+
+	engines.push_back({"advance", [](const Board& board, uint64_t generations, Board& result, GenerationStats& stats) {
+		Universe universe(5, 5, 0); // history on, the way the window runs it
+		EngineVerifier::load(board, universe);
+		universe.advance(generations);
+		result.name = board.name;
+		universe.copyPackedGrid(result.packed, result.width, result.height);
+		stats = universe.getStats();
+		return true;
+	}});
+
+	engines.push_back({"nextGeneration threads 4", [](const Board& board, uint64_t generations, Board& result, GenerationStats& stats) {
+		Universe universe(5, 5, 0);
+		universe.setHistoryEnabled(false);
+		universe.setThreadCount(4); // large boards are stepped as tiles on the pool
+		EngineVerifier::load(board, universe);
+		for (uint64_t i = 0; i < generations; i++) {
+			universe.nextGeneration(false);
+		}
+		result.name = board.name;
+		universe.copyPackedGrid(result.packed, result.width, result.height);
+		stats = universe.getStats();
+		return true;
+	}});
+
+	// Universe::step, optionally split in two calls so the second one starts from what the first left behind
+	auto universeStep = [](int block, unsigned int threads, uint64_t first_call) {
+		return [block, threads, first_call](const Board& board, uint64_t generations, Board& result, GenerationStats& stats) {
+			Universe universe(5, 5, 0);
+			universe.setHistoryEnabled(false);
+			universe.setBlockGenerations(block);
+			universe.setThreadCount(threads);
+			EngineVerifier::load(board, universe);
+
+			uint64_t first = std::min(first_call, generations);
+			if (first > 0) universe.step(first, false);
+			universe.step(generations - first, false);
+			result.name = board.name;
+			universe.copyPackedGrid(result.packed, result.width, result.height);
+			stats = universe.getStats();
+			return true;
+		};
+	};
+	for (int block : {1, 8, 64}) {
+		engines.push_back({"step block " + std::to_string(block), universeStep(block, 1, 0)});
+	}
+	engines.push_back({"step block 8 threads 4 in two calls", universeStep(8, 4, 5)});
+
+	// TileStepper on its own with small tiles, so even the corpus's boards are many tiles and most get skipped
+	auto tileStep = [](int block, int tile_rows, int tile_words, unsigned int threads, uint64_t first_call) {
+		return [block, tile_rows, tile_words, threads, first_call](const Board& board, uint64_t generations, Board& result, GenerationStats& stats) {
+			TileStepper stepper(block, tile_rows, tile_words, threads);
+			BitGrid grid(board.width, board.height), scratch;
+			int words = grid.getWordsPerRow();
+			for (int y = 0; y < board.height; y++) {
+				std::copy(board.packed.begin() + static_cast<size_t>(y) * words, board.packed.begin() + static_cast<size_t>(y + 1) * words, grid.row(y));
+			}
+
+			uint64_t first = std::min(first_call, generations);
+			if (first > 0) stepper.step(grid, scratch, first, stats);
+			stepper.step(grid, scratch, generations - first, stats);
+
+			result = EngineVerifier::makeBoard(board.name, board.width, board.height);
+			for (int y = 0; y < board.height; y++) {
+				std::copy(grid.row(y), grid.row(y) + words, result.packed.begin() + static_cast<size_t>(y) * words);
+			}
+			return true;
+		};
+	};
+	engines.push_back({"tiles 8 x 1 block 8", tileStep(8, 8, 1, 1, 0)});
+	engines.push_back({"tiles 8 x 1 block 3 threads 3 in two calls", tileStep(3, 8, 1, 3, 7)});
+	engines.push_back({"tiles 16 x 2 block 64 threads 2 in two calls", tileStep(64, 16, 2, 2, 100)});
+	engines.push_back({"tiles 128 x 32 block 8 threads 4", tileStep(8, 128, 32, 4, 0)});
+
+#if defined(__unix__) || defined(__APPLE__)
+	int processes = this->config.processes;
+	if (processes > 1) {
+		engines.push_back({"distributed " + std::to_string(processes) + " processes", [processes](const Board& board, uint64_t generations, Board& result, GenerationStats& stats) {
+			DistributedStepper::Config config;
+			config.width = board.width;
+			config.height = board.height;
+			config.generations = generations;
+			config.processes = processes;
+			config.verify = false;
+
+			DistributedStepper stepper(config);
+			if (!stepper.partition()) return false; // too small to split that many ways
+
+			result = EngineVerifier::makeBoard(board.name, board.width, board.height);
+			return stepper.run(board.packed, result.packed, stats);
+		}});
+	} // needs fork
+#endif
+	return engines;
+}
+
+int EngineVerifier::getFailureCount() const {
+	return this->failures;
+}
+
+EngineVerifier::Board EngineVerifier::reference(const Board& board, uint64_t generations) {
+	Universe universe(5, 5, 0);
+	universe.setHistoryEnabled(false);
+	universe.setThreadCount(1); // the row by row loop, no tiles
+	EngineVerifier::load(board, universe);
+	for (uint64_t i = 0; i < generations; i++) {
+		universe.nextGeneration(false);
+	}
+
+	Board result;
+	result.name = board.name;
+	universe.copyPackedGrid(result.packed, result.width, result.height);
+	return result;
+}
+
+EngineVerifier::Outcome EngineVerifier::compare(const Engine& engine, const Board& board, const Board& expected, uint64_t generations, std::string* difference) const {
+	Board actual;
+	GenerationStats stats;
+	if (!engine.run(board, generations, actual, stats)) return Outcome::Skipped;
+
+	GenerationStats expected_stats = EngineVerifier::describe(expected);
+	std::string found;
+	if (actual.width != expected.width || actual.height != expected.height) {
+		found = "board is " + std::to_string(actual.width) + " x " + std::to_string(actual.height);
+	} else if (actual.packed != expected.packed) {
+		for (int y = 0; y < actual.height && found.empty(); y++) {
+			for (int x = 0; x < actual.width; x++) {
+				if (EngineVerifier::isAlive(actual, x, y) != EngineVerifier::isAlive(expected, x, y)) {
+					found = "cell (" + std::to_string(x) + ", " + std::to_string(y) + ") is " + (EngineVerifier::isAlive(actual, x, y) ? "alive" : "dead");
+					break;
+				}
+			}
+		} // first cell in reading order
+	} else if (stats.population != expected_stats.population || stats.hash != expected_stats.hash) {
+		found = "reported population " + std::to_string(stats.population) + " and hash " + std::to_string(stats.hash)
+			+ ", the board has " + std::to_string(expected_stats.population) + " and " + std::to_string(expected_stats.hash);
+	} // the board is right but the stats describing it aren't
+	if (found.empty()) return Outcome::Agrees;
+
+	if (difference) *difference = found;
+	return Outcome::Differs;
+}
+
+EngineVerifier::Board EngineVerifier::minimize(const Engine& engine, const Board& board, uint64_t& generations) const {
+	int attempts = 0;
+	auto fails = [this, &engine, &attempts](const Board& candidate, uint64_t candidate_generations) {
+		if (attempts >= this->config.max_attempts) return false; // out of budget, keep what's been found
+		attempts++;
+		return this->compare(engine, candidate, EngineVerifier::reference(candidate, candidate_generations), candidate_generations, nullptr) == Outcome::Differs;
+	};
+	auto fewestGenerations = [&fails, &generations](const Board& candidate) {
+		uint64_t low = 1, high = generations;
+		while (low < high) {
+			uint64_t middle = low + (high - low) / 2;
+			if (fails(candidate, middle)) high = middle;
+			else low = middle + 1;
+		}
+		generations = high;
+	}; // a failure usually persists once it appears, so bisecting finds the first bad generation
+
+	Board current = board;
+	current.name = board.name + " minimized";
+	fewestGenerations(current);
+
+	// drop live cells, large groups first
+	std::vector<std::pair<int, int>> live;
+	for (int y = 0; y < current.height; y++) {
+		for (int x = 0; x < current.width; x++) {
+			if (EngineVerifier::isAlive(current, x, y)) live.push_back({x, y});
+		}
+	}
+	for (size_t chunk = std::max<size_t>(live.size() / 2, 1); chunk >= 1 && !live.empty(); chunk /= 2) {
+		for (size_t i = 0; i < live.size();) {
+			Board candidate = current;
+			size_t end = std::min(i + chunk, live.size());
+			for (size_t k = i; k < end; k++) {
+				EngineVerifier::setAlive(candidate, live[k].first, live[k].second, false);
+			}
+
+			if (fails(candidate, generations)) {
+				current = candidate;
+				live.erase(live.begin() + i, live.begin() + end);
+			} else {
+				i = end;
+			}
+		}
+		if (chunk == 1) break;
+	}
+
+	// trim each side of the board, down to the 5 x 5 loadFromFile pads smaller boards to
+	for (int side = 0; side < 4; side++) {
+		bool horizontal = side < 2;
+		for (int trim = ((horizontal ? current.width : current.height) - 5) / 2; trim >= 1;) {
+			int extent = (horizontal ? current.width : current.height) - trim;
+			if (extent < 5) {
+				trim /= 2;
+				continue;
+			}
+
+			Board candidate = side == 0 ? EngineVerifier::crop(current, trim, 0, extent, current.height) // left
+				: side == 1 ? EngineVerifier::crop(current, 0, 0, extent, current.height) // right
+				: side == 2 ? EngineVerifier::crop(current, 0, trim, current.width, extent) // top
+				: EngineVerifier::crop(current, 0, 0, current.width, extent); // bottom
+			if (fails(candidate, generations)) current = candidate;
+			else trim /= 2;
+		}
+	}
+
+	fewestGenerations(current); // fewer cells may fail sooner
+	return current;
+}
+
+bool EngineVerifier::writeReproducer(const Board& board, const std::string& engine, std::string& path) const {
+	std::string name = "verify-" + engine + "-" + board.name;
+	for (char& c : name) {
+		if (!std::isalnum(static_cast<unsigned char>(c))) c = '-';
+	}
+	path = this->config.output_directory + "/" + name + ".txt";
+
+	std::ofstream file(path);
+	if (!file.is_open()) {
+		std::cerr << "ERROR: Couldn't write reproducer " << path << std::endl;
+		return false;
+	}
+
+	file << board.width << " " << board.height << std::endl; // same layout as Universe::exportToFile
+	for (int y = 0; y < board.height; y++) {
+		for (int x = 0; x < board.width; x++) {
+			file << (EngineVerifier::isAlive(board, x, y) ? 1 : 0);
+		}
+		file << std::endl;
+	}
+	return true;
+}
+
+EngineVerifier::Board EngineVerifier::makeBoard(const std::string& name, int width, int height) {
+	Board board;
+	board.name = name;
+	board.width = width;
+	board.height = height;
+	board.packed.assign(static_cast<size_t>(height) * ((width + 63) / 64), 0);
+	return board;
+}
+
+void EngineVerifier::stamp(Board& board, const std::vector<std::string>& rows, int x, int y) {
+	for (int i = 0; i < static_cast<int>(rows.size()); i++) {
+		for (int j = 0; j < static_cast<int>(rows[i].size()); j++) {
+			if (rows[i][j] == 'O' && x + j >= 0 && x + j < board.width && y + i >= 0 && y + i < board.height) {
+				EngineVerifier::setAlive(board, x + j, y + i, true);
+			}
+		}
+	}
+}
+
+EngineVerifier::Board EngineVerifier::crop(const Board& board, int x, int y, int width, int height) {
+	Board result = EngineVerifier::makeBoard(board.name, width, height);
+	for (int i = 0; i < height; i++) {
+		for (int j = 0; j < width; j++) {
+			if (EngineVerifier::isAlive(board, x + j, y + i)) EngineVerifier::setAlive(result, j, i, true);
+		}
+	}
+	return result;
+}
+
+bool EngineVerifier::isAlive(const Board& board, int x, int y) {
+	size_t words = static_cast<size_t>((board.width + 63) / 64);
+	return (board.packed[y * words + x / 64] >> (x % 64)) & 1;
+}
+
+void EngineVerifier::setAlive(Board& board, int x, int y, bool alive) {
+	size_t words = static_cast<size_t>((board.width + 63) / 64);
+	uint64_t& word = board.packed[y * words + x / 64];
+	if (alive) word |= uint64_t(1) << (x % 64);
+	else word &= ~(uint64_t(1) << (x % 64));
+}
+
+GenerationStats EngineVerifier::describe(const Board& board) {
+	GenerationStats stats;
+	int words = (board.width + 63) / 64;
+	for (int y = 0; y < board.height; y++) {
+		const uint64_t* row = board.packed.data() + static_cast<size_t>(y) * words;
+		TileStepper::accumulateRow(y, 0, row, row, words, stats);
+	}
+	return stats;
+}
+
+void EngineVerifier::load(const Board& board, Universe& universe) {
+	universe.setGridSize(board.width, board.height);
+	universe.reset();
+
+	EditBatch batch;
+	for (int y = 0; y < board.height; y++) {
+		for (int x = 0; x < board.width; x++) {
+			if (EngineVerifier::isAlive(board, x, y)) batch.cells.push_back({x, y, CellState::Alive});
+		}
+	}
+	universe.submitEdit(std::move(batch));
+	universe.applyPendingEdits();
+}
+
+bool EngineVerifier::parseArguments(int argc, char* argv[], Config& config) {
+	bool parsed = CommandLine::parseOptions(argc, argv, [&config](const std::string& option, const std::string& value) {
+		if (option == "--generations") config.generations = static_cast<uint64_t>(CommandLine::toInteger(value, 1, INT64_MAX));
+		else if (option == "--seed") config.first_seed = static_cast<unsigned int>(CommandLine::toInteger(value, 0, UINT32_MAX));
+		else if (option == "--seeds") config.seeds = static_cast<int>(CommandLine::toInteger(value, 0, INT32_MAX));
+		else if (option == "--processes") config.processes = static_cast<int>(CommandLine::toInteger(value, 1, CommandLine::getMaxThreads())); // the distributed engine forks each one
+		else if (option == "--engine") config.engine = value;
+		else if (option == "--minimize") config.minimize = CommandLine::toInteger(value, 0, 1) != 0;
+		else if (option == "--attempts") config.max_attempts = static_cast<int>(CommandLine::toInteger(value, 0, INT32_MAX));
+		else if (option == "--output") config.output_directory = value;
+		else return false;
+		return true;
+	});
+	if (!parsed) return false;
+
+	if (config.generations == 0 || config.seeds < 0 || config.max_attempts < 0) {
+		std::cerr << "ERROR: Invalid generation, seed or attempt count" << std::endl;
+		return false;
+	} // exit if there's nothing to compare
+
+	return true;
+}
+
+int EngineVerifier::runFromArguments(int argc, char* argv[]) {
+	Config config;
+	if (!EngineVerifier::parseArguments(argc, argv, config)) {
+		return 1;
+	}
+
+	EngineVerifier verifier(config);
+	return verifier.verify() ? 0 : 1;
+}
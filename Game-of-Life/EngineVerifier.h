@@ -0,0 +1,74 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "GenerationStats.h"
+
+class Universe;
+
+// golden output check of every stepping engine against Universe::nextGeneration, one generation at a time
+// each engine runs a corpus of known patterns and random soups and has to reproduce the reference board exactly,
+// along with the population and hash it reports; a board that differs is shrunk to a small reproducer and saved
+// in the format loadFromFile reads, so the failure can be replayed in the window
+// cells past the edge of the board are dead, it's the only boundary the engines have
+class EngineVerifier {
+public:
+	struct Config {
+		uint64_t generations = 200;
+		unsigned int first_seed = 1;
+		int seeds = 6; // random soups of each size
+		int processes = 4; // workers of the distributed engine
+		std::string engine; // only run engines whose name contains this, empty runs them all
+		bool minimize = true;
+		int max_attempts = 2000; // engine runs spent shrinking one failure
+		std::string output_directory = "."; // where reproducers are written
+	};
+
+	struct Board {
+		std::string name;
+		int width = 0;
+		int height = 0;
+		std::vector<uint64_t> packed; // rows padded to whole words, as from Universe::copyPackedGrid
+	};
+
+	struct Engine {
+		std::string name;
+		std::function<bool(const Board&, uint64_t, Board&, GenerationStats&)> run; // board after the generations and the stats it reports, false if it couldn't run
+	};
+
+	EngineVerifier(const Config& config);
+
+	bool verify(); // returns true if every engine agrees with the reference on every board
+	std::vector<Board> buildCorpus() const;
+	std::vector<Engine> buildEngines() const;
+	int getFailureCount() const;
+
+	static Board reference(const Board& board, uint64_t generations); // the board after Universe::nextGeneration ran that many times
+	static bool parseArguments(int argc, char* argv[], Config& config); // --generations, --seed, --seeds, --processes, --engine, --minimize, --attempts, --output
+	static int runFromArguments(int argc, char* argv[]); // entry point for --verify, returns the process exit code
+
+private:
+	enum class Outcome {
+		Agrees,
+		Differs,
+		Skipped // the engine can't run this board, e.g. too small to split
+	};
+
+	// ---- methods ----
+	Outcome compare(const Engine& engine, const Board& board, const Board& expected, uint64_t generations, std::string* difference) const; // expected is the reference's board, difference describes the first mismatch
+	Board minimize(const Engine& engine, const Board& board, uint64_t& generations) const; // smallest board and generation count that still fail, within max_attempts runs
+	bool writeReproducer(const Board& board, const std::string& engine, std::string& path) const;
+
+	static Board makeBoard(const std::string& name, int width, int height);
+	static void stamp(Board& board, const std::vector<std::string>& rows, int x, int y); // 'O' is alive, cells past the edge are dropped
+	static Board crop(const Board& board, int x, int y, int width, int height);
+	static bool isAlive(const Board& board, int x, int y);
+	static void setAlive(Board& board, int x, int y, bool alive);
+	static GenerationStats describe(const Board& board); // population and hash the way the engines compute them
+	static void load(const Board& board, Universe& universe);
+
+	// ---- attributes ----
+	Config config;
+	int failures = 0;
+};
@@ -1,4 +1,6 @@
 #include "Game.h"
+#include "ResourceCache.h"
+#include "Profiler.h"
 
 Game::Game() : window(nullptr), renderer(nullptr), universe(nullptr), grid_view(nullptr), ui_ctrl(nullptr), input_handler(nullptr), is_running(false) {}
 
@@ -7,9 +9,11 @@ Game::~Game() {
 }
 
 void Game::run() {
+    Profiler::instance().setThreadName("main");
     this->init();
     while (this->is_running) {
         this->handleEvents();
+        this->update();
         this->render();
         SDL_Delay(10);
     } // game loop
@@ -60,12 +64,19 @@ void Game::handleEvents() {
     }
 }
 
+void Game::update() {
+    this->ui_ctrl->update(); // apply queued edits while paused
+}
+
 void Game::render() {
+    PROFILE_SCOPE("Game::render");
     SDL_SetRenderDrawColor(this->renderer, 26, 26, 25, 255); // background color
     SDL_RenderClear(this->renderer); // clear renderer
 
     this->grid_view->render(this->renderer, *(this->universe), 200); // render simulation_grid
+    this->grid_view->renderSelection(this->renderer); // render selected region
     this->grid_view->renderBrush(this->renderer); // render brush
+    this->grid_view->renderPaste(this->renderer); // render the pattern being pasted
     this->ui_ctrl->render(this->renderer); // render menu
 
     if (this->ui_ctrl->isHelpWindowOpen()) {
@@ -77,13 +88,20 @@ void Game::render() {
 
 void Game::cleanup() {
     SDL_StopTextInput();
+    UI::ResourceCache::instance().clear(); // free cached fonts and textures before their renderer and TTF go away
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
     IMG_Quit();
     TTF_Quit();
     SDL_Quit();
+    delete input_handler;
+    delete ui_ctrl; // stops the simulation thread before the universe goes away
+    delete grid_view;
     delete universe;
-	delete grid_view;
-	delete ui_ctrl;
-	delete input_handler;
+    input_handler = nullptr;
+    ui_ctrl = nullptr;
+    grid_view = nullptr;
+    universe = nullptr;
+    renderer = nullptr;
+    window = nullptr;
 }
@@ -14,6 +14,7 @@
 	private:
 		void init();
 		void handleEvents();
+		void update();
 		void render();
 		void cleanup();
 
@@ -0,0 +1,212 @@
+#include "GenerationHistory.h"
+#include <algorithm>
+#include <cstring>
+
+GenerationHistory::GenerationHistory(size_t memory_budget, int keyframe_interval) {
+	this->memory_budget = memory_budget;
+	this->keyframe_interval = std::max(keyframe_interval, 1);
+}
+
+#pragma region Recording
+void GenerationHistory::record(uint64_t generation, int width, int height, const GridWords& packed) {
+	if (!this->frames.empty() && generation == this->getNewestGeneration()) {
+		if (this->frames.size() == 1) {
+			this->clear();
+		} else {
+			this->truncateAfter(generation - 1); // the delta below is taken against the generation before again
+		}
+	} // the board was edited after this generation was recorded, its frame is out of date
+
+	if (!this->frames.empty() && (generation != this->getNewestGeneration() + 1 || width != this->width || height != this->height || packed.size() != this->frame_words)) {
+		this->clear();
+	} // start a new timeline if this doesn't continue the current one
+
+	Frame frame;
+	frame.generation = generation;
+	frame.keyframe = this->frames.empty() || this->frames_since_keyframe + 1 >= this->keyframe_interval;
+
+	if (frame.keyframe) {
+		compress(packed, frame.data);
+		this->frames_since_keyframe = 0;
+	} else {
+		this->scratch.resize(packed.size());
+		for (size_t i = 0; i < packed.size(); i++) {
+			this->scratch[i] = packed[i] ^ this->previous[i];
+		} // only changed bits are set in the delta
+
+		compress(this->scratch, frame.data);
+		this->frames_since_keyframe++;
+	}
+
+	this->width = width;
+	this->height = height;
+	this->frame_words = packed.size();
+	this->previous = packed;
+	this->bytes_used += frame.data.size();
+	this->frames.push_back(std::move(frame));
+
+	this->enforceBudget();
+}
+
+void GenerationHistory::truncateAfter(uint64_t generation) {
+	if (!this->contains(generation)) {
+		this->clear();
+		return;
+	} // nothing to keep
+
+	while (this->frames.back().generation > generation) {
+		this->bytes_used -= this->frames.back().data.size();
+		this->frames.pop_back();
+	} // drop newer frames
+
+	this->frames_since_keyframe = 0;
+	for (auto it = this->frames.rbegin(); it != this->frames.rend() && !it->keyframe; ++it) {
+		this->frames_since_keyframe++;
+	} // count deltas since the last keyframe
+
+	this->rebuild(generation, this->previous); // next delta is taken against the rewound state
+}
+
+void GenerationHistory::clear() {
+	this->frames.clear();
+	this->previous.clear();
+	this->previous.shrink_to_fit();
+	this->scratch.clear();
+	this->scratch.shrink_to_fit();
+	this->bytes_used = 0;
+	this->frames_since_keyframe = 0;
+}
+#pragma endregion
+
+#pragma region Lookup
+bool GenerationHistory::rebuild(uint64_t generation, GridWords& packed) const {
+	if (!this->contains(generation)) return false;
+
+	size_t index = generation - this->frames.front().generation; // frames are contiguous
+	size_t keyframe_index = index;
+	while (!this->frames[keyframe_index].keyframe) {
+		keyframe_index--;
+	} // find the closest keyframe at or before the generation
+
+	packed.assign(this->frame_words, 0);
+	decompress(this->frames[keyframe_index].data, packed, false);
+
+	for (size_t i = keyframe_index + 1; i <= index; i++) {
+		decompress(this->frames[i].data, packed, true);
+	} // replay deltas up to the requested generation
+
+	return true;
+}
+
+bool GenerationHistory::contains(uint64_t generation) const {
+	return !this->frames.empty() && generation >= this->getOldestGeneration() && generation <= this->getNewestGeneration();
+}
+
+bool GenerationHistory::empty() const {
+	return this->frames.empty();
+}
+
+uint64_t GenerationHistory::getOldestGeneration() const {
+	return this->frames.empty() ? 0 : this->frames.front().generation;
+}
+
+uint64_t GenerationHistory::getNewestGeneration() const {
+	return this->frames.empty() ? 0 : this->frames.back().generation;
+}
+
+int GenerationHistory::getWidth() const {
+	return this->width;
+}
+
+int GenerationHistory::getHeight() const {
+	return this->height;
+}
+#pragma endregion
+
+#pragma region Budget
+void GenerationHistory::setMemoryBudget(size_t bytes) {
+	this->memory_budget = bytes;
+	this->enforceBudget();
+}
+
+size_t GenerationHistory::getMemoryBudget() const {
+	return this->memory_budget;
+}
+
+size_t GenerationHistory::getMemoryUsage() const {
+	return this->bytes_used + (this->previous.capacity() + this->scratch.capacity()) * sizeof(uint64_t);
+}
+
+void GenerationHistory::setKeyframeInterval(int interval) {
+	this->keyframe_interval = std::max(interval, 1);
+}
+
+void GenerationHistory::enforceBudget() {
+	while (this->getMemoryUsage() > this->memory_budget && this->frames.size() > 1) {
+		auto next_keyframe = std::find_if(this->frames.begin() + 1, this->frames.end(), [](const Frame& frame) {
+			return frame.keyframe;
+		});
+		if (next_keyframe == this->frames.end()) return; // always keep the newest keyframe and its deltas
+
+		for (auto it = this->frames.begin(); it != next_keyframe; ++it) {
+			this->bytes_used -= it->data.size();
+		}
+		this->frames.erase(this->frames.begin(), next_keyframe); // drop the oldest keyframe with its deltas
+	}
+}
+#pragma endregion
+
+// format: repeated [zero run length][literal count][literal words], lengths as base-128 varints
+void GenerationHistory::compress(const GridWords& words, std::vector<uint8_t>& out) {
+	auto writeVarint = [&out](size_t value) {
+		while (value >= 0x80) {
+			out.push_back(static_cast<uint8_t>(value) | 0x80);
+			value >>= 7;
+		}
+		out.push_back(static_cast<uint8_t>(value));
+	};
+
+	out.clear();
+	size_t i = 0;
+	while (i < words.size()) {
+		size_t zero_start = i;
+		while (i < words.size() && words[i] == 0) i++;
+		size_t literal_start = i;
+		while (i < words.size() && words[i] != 0) i++;
+
+		writeVarint(literal_start - zero_start);
+		writeVarint(i - literal_start);
+
+		size_t offset = out.size();
+		out.resize(offset + (i - literal_start) * sizeof(uint64_t));
+		std::memcpy(out.data() + offset, words.data() + literal_start, (i - literal_start) * sizeof(uint64_t));
+	}
+	out.shrink_to_fit();
+}
+
+void GenerationHistory::decompress(const std::vector<uint8_t>& data, GridWords& words, bool xor_into) {
+	size_t pos = 0;
+	auto readVarint = [&]() {
+		size_t value = 0;
+		int shift = 0;
+		while (pos < data.size()) {
+			uint8_t byte = data[pos++];
+			value |= static_cast<size_t>(byte & 0x7F) << shift;
+			if (!(byte & 0x80)) break;
+			shift += 7;
+		}
+		return value;
+	};
+
+	size_t i = 0;
+	while (pos < data.size() && i < words.size()) {
+		i += readVarint(); // zero words leave the target untouched in both modes
+		size_t count = std::min(readVarint(), words.size() - std::min(i, words.size()));
+
+		for (size_t k = 0; k < count; k++, i++, pos += sizeof(uint64_t)) {
+			uint64_t word;
+			std::memcpy(&word, data.data() + pos, sizeof(uint64_t));
+			words[i] = xor_into ? (words[i] ^ word) : word;
+		}
+	}
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <deque>
+#include <vector>
+#include "GridAllocator.h"
+
+// bounded history of bit-packed generations, stored as periodic keyframes plus xor deltas
+// both are run-length compressed on zero words, so sparse boards and small changes are cheap to keep
+class GenerationHistory {
+public:
+	GenerationHistory(size_t memory_budget = 64 * 1024 * 1024, int keyframe_interval = 32);
+
+#pragma region Recording
+public:
+	// ---- methods ----
+	void record(uint64_t generation, int width, int height, const GridWords& packed); // starts over if generation doesn't follow the newest one, replaces the newest if it's the same generation (e.g. edited since)
+	void truncateAfter(uint64_t generation); // drop everything newer, used when rewinding starts a new timeline
+	void clear();
+#pragma endregion
+
+#pragma region Lookup
+public:
+	// ---- methods ----
+	bool rebuild(uint64_t generation, GridWords& packed) const; // returns false if the generation isn't retained
+	bool contains(uint64_t generation) const;
+	bool empty() const;
+	uint64_t getOldestGeneration() const;
+	uint64_t getNewestGeneration() const;
+	int getWidth() const;
+	int getHeight() const;
+#pragma endregion
+
+#pragma region Budget
+public:
+	// ---- methods ----
+	void setMemoryBudget(size_t bytes);
+	size_t getMemoryBudget() const;
+	size_t getMemoryUsage() const; // compressed frames plus the last recorded state
+	void setKeyframeInterval(int interval);
+#pragma endregion
+
+private:
+	struct Frame {
+		uint64_t generation;
+		bool keyframe;
+		std::vector<uint8_t> data;
+	};
+
+	// ---- methods ----
+	static void compress(const GridWords& words, std::vector<uint8_t>& out);
+	static void decompress(const std::vector<uint8_t>& data, GridWords& words, bool xor_into);
+	void enforceBudget();
+
+	// ---- attributes ----
+	std::deque<Frame> frames;
+	GridWords previous; // last recorded state, deltas are taken against it
+	GridWords scratch;
+	int width = 0;
+	int height = 0;
+	size_t frame_words = 0; // words in a recorded state, including the grid's row padding
+	size_t bytes_used = 0; // compressed frame bytes
+	size_t memory_budget;
+	int keyframe_interval;
+	int frames_since_keyframe = 0;
+};
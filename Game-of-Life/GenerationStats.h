@@ -0,0 +1,41 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+
+// per-generation statistics, produced as a side effect of stepping
+struct GenerationStats {
+	uint64_t generation = 0;
+	int64_t population = 0;
+	int64_t births = 0;
+	int64_t deaths = 0;
+	int min_x = -1; // live bounding box, -1 when the board is empty
+	int min_y = -1;
+	int max_x = -1;
+	int max_y = -1;
+	uint64_t hash = 0; // hash of the board, equal boards have equal hashes
+
+	void addLiveSpan(int first_x, int last_x, int y) {
+		if (this->min_x < 0) {
+			this->min_x = first_x;
+			this->max_x = last_x;
+			this->min_y = this->max_y = y;
+			return;
+		} // first live cells start the bounding box
+
+		this->min_x = std::min(this->min_x, first_x);
+		this->max_x = std::max(this->max_x, last_x);
+		this->min_y = std::min(this->min_y, y);
+		this->max_y = std::max(this->max_y, y);
+	}
+
+	void merge(const GenerationStats& other) {
+		this->population += other.population;
+		this->births += other.births;
+		this->deaths += other.deaths;
+		this->hash ^= other.hash;
+		if (other.min_x >= 0) {
+			this->addLiveSpan(other.min_x, other.max_x, other.min_y);
+			this->max_y = std::max(this->max_y, other.max_y);
+		}
+	} // combine stats of disjoint parts of a board
+};
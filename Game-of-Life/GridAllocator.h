@@ -0,0 +1,51 @@
+#pragma once
+#include <cstdint>
+#include <new>
+#include <utility>
+#include <vector>
+#include "GridArena.h"
+
+// allocator for grid words, backed by the grid arena and leaving new elements uninitialized
+// large buffers aren't touched until whoever fills them first, which is what decides the numa node their pages live on
+template <typename T>
+struct GridAllocator {
+	using value_type = T;
+
+	GridAllocator() = default;
+	template <typename U>
+	GridAllocator(const GridAllocator<U>&) {}
+
+	T* allocate(size_t count) {
+		if (count > static_cast<size_t>(-1) / sizeof(T)) throw std::bad_alloc();
+
+		void* block = GridArena::allocate(count * sizeof(T));
+		if (!block) throw std::bad_alloc();
+		return static_cast<T*>(block);
+	}
+
+	void deallocate(T* pointer, size_t count) {
+		GridArena::release(pointer, count * sizeof(T));
+	}
+
+	template <typename U>
+	void construct(U* pointer) noexcept {
+		::new (static_cast<void*>(pointer)) U;
+	} // default initialization, resize() doesn't write anything
+
+	template <typename U, typename... Args>
+	void construct(U* pointer, Args&&... args) {
+		::new (static_cast<void*>(pointer)) U(std::forward<Args>(args)...);
+	}
+
+	template <typename U>
+	bool operator==(const GridAllocator<U>&) const {
+		return true;
+	}
+
+	template <typename U>
+	bool operator!=(const GridAllocator<U>&) const {
+		return false;
+	}
+};
+
+using GridWords = std::vector<uint64_t, GridAllocator<uint64_t>>; // bit-packed rows of a board
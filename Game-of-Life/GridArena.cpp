@@ -0,0 +1,264 @@
+#include "GridArena.h"
+#include <algorithm>
+#include <cstdint>
+#include <new>
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#include <winioctl.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <cstdlib>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+#include <iostream>
+
+std::mutex GridArena::mutex;
+std::unordered_map<void*, GridArena::Mapping> GridArena::mappings;
+GridArena::Stats GridArena::stats;
+std::atomic<bool> GridArena::huge_pages{true};
+std::string GridArena::backing_directory;
+
+void* GridArena::allocate(size_t bytes) {
+	if (bytes == 0) bytes = 1;
+
+	if (bytes >= MAP_THRESHOLD) {
+		std::string directory = GridArena::getBackingDirectory();
+		Mapping mapping;
+		void* block = directory.empty() ? GridArena::map(bytes, mapping) : GridArena::mapFile(bytes, directory, mapping);
+		if (block) {
+			std::lock_guard<std::mutex> lock(GridArena::mutex);
+			GridArena::mappings[block] = mapping;
+			GridArena::addStats(mapping, true);
+			return block;
+		}
+		if (!directory.empty()) return nullptr; // a board meant for disk would only run out of memory on the heap
+	} // fall through to the heap if the os won't map it
+
+	void* block = ::operator new(bytes, std::align_val_t(CACHE_LINE), std::nothrow);
+	if (block) {
+		std::lock_guard<std::mutex> lock(GridArena::mutex);
+		GridArena::stats.heap_bytes += bytes;
+		GridArena::updatePeak();
+	}
+	return block;
+}
+
+void GridArena::release(void* pointer, size_t bytes) {
+	if (!pointer) return;
+	if (bytes == 0) bytes = 1;
+
+	{
+		std::lock_guard<std::mutex> lock(GridArena::mutex);
+		auto it = GridArena::mappings.find(pointer);
+		if (it != GridArena::mappings.end()) {
+			Mapping mapping = it->second;
+			GridArena::mappings.erase(it);
+			GridArena::addStats(mapping, false);
+			GridArena::unmap(mapping);
+			return;
+		} // mapped block
+
+		GridArena::stats.heap_bytes -= bytes;
+	}
+	::operator delete(pointer, std::align_val_t(CACHE_LINE));
+}
+
+void GridArena::setHugePages(bool enabled) {
+	GridArena::huge_pages.store(enabled);
+}
+
+bool GridArena::getHugePages() {
+	return GridArena::huge_pages.load();
+}
+
+void GridArena::setBackingDirectory(const std::string& directory) {
+	std::lock_guard<std::mutex> lock(GridArena::mutex);
+	GridArena::backing_directory = directory;
+}
+
+std::string GridArena::getBackingDirectory() {
+	std::lock_guard<std::mutex> lock(GridArena::mutex);
+	return GridArena::backing_directory;
+}
+
+GridArena::PageKind GridArena::getKind(const void* pointer) {
+	std::lock_guard<std::mutex> lock(GridArena::mutex);
+	auto it = GridArena::mappings.find(const_cast<void*>(pointer));
+	return it != GridArena::mappings.end() ? it->second.kind : PageKind::Heap;
+}
+
+GridArena::Stats GridArena::getStats() {
+	std::lock_guard<std::mutex> lock(GridArena::mutex);
+	return GridArena::stats;
+}
+
+void GridArena::resetPeak() {
+	std::lock_guard<std::mutex> lock(GridArena::mutex);
+	GridArena::stats.peak_bytes = GridArena::stats.total();
+}
+
+const char* GridArena::getKindName(PageKind kind) {
+	switch (kind) {
+	case PageKind::Heap: return "heap";
+	case PageKind::Normal: return "normal pages";
+	case PageKind::Transparent: return "transparent huge pages";
+	case PageKind::Huge: return "huge pages";
+	case PageKind::File: return "backing file";
+	}
+	return "unknown";
+}
+
+void* GridArena::map(size_t bytes, Mapping& mapping) {
+	size_t length = (bytes + HUGE_PAGE - 1) / HUGE_PAGE * HUGE_PAGE;
+	bool huge = GridArena::huge_pages.load();
+
+#if defined(_WIN32)
+	if (huge) {
+		SIZE_T large_page = GetLargePageMinimum();
+		if (large_page > 0) {
+			SIZE_T large_length = (bytes + large_page - 1) / large_page * large_page;
+			void* block = VirtualAlloc(nullptr, large_length, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+			if (block) {
+				mapping = {block, large_length, PageKind::Huge};
+				return block;
+			}
+		} // needs the lock pages in memory privilege, without it this fails and normal pages are used
+	}
+
+	void* block = VirtualAlloc(nullptr, length, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE); // 64KB aligned, pages are placed on first touch
+	if (!block) return nullptr;
+	mapping = {block, length, PageKind::Normal};
+	return block;
+#elif defined(__unix__) || defined(__APPLE__)
+#ifdef MAP_HUGETLB
+	if (huge) {
+		void* block = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+		if (block != MAP_FAILED) {
+			mapping = {block, length, PageKind::Huge};
+			return block;
+		}
+	} // only works if huge pages were reserved (vm.nr_hugepages), usually they aren't
+#endif
+
+	size_t span = huge ? length + HUGE_PAGE : length; // room to slide the block onto a huge page boundary
+	void* base = mmap(nullptr, span, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (base == MAP_FAILED) return nullptr;
+	mapping = {base, span, PageKind::Normal};
+	if (!huge) return base;
+
+	uintptr_t address = reinterpret_cast<uintptr_t>(base);
+	uintptr_t aligned = (address + HUGE_PAGE - 1) / HUGE_PAGE * HUGE_PAGE;
+#ifdef MADV_HUGEPAGE
+	if (madvise(reinterpret_cast<void*>(aligned), length, MADV_HUGEPAGE) == 0) {
+		mapping.kind = PageKind::Transparent;
+	} // the kernel backs it with huge pages as they're touched, if thp isn't disabled
+#endif
+	return reinterpret_cast<void*>(aligned);
+#else
+	(void)length;
+	(void)huge;
+	(void)mapping;
+	return nullptr;
+#endif
+}
+
+void* GridArena::mapFile(size_t bytes, const std::string& directory, Mapping& mapping) {
+	size_t length = (bytes + HUGE_PAGE - 1) / HUGE_PAGE * HUGE_PAGE;
+
+#if defined(_WIN32)
+	char path[MAX_PATH];
+	if (!GetTempFileNameA(directory.c_str(), "gol", 0, path)) {
+		std::cerr << "ERROR: Couldn't create a backing file in " << directory << std::endl;
+		return nullptr;
+	}
+
+	HANDLE file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		std::cerr << "ERROR: Couldn't open backing file " << path << std::endl;
+		DeleteFileA(path);
+		return nullptr;
+	} // deleted by the os once the last handle closes
+
+	DWORD returned = 0;
+	DeviceIoControl(file, FSCTL_SET_SPARSE, nullptr, 0, nullptr, 0, &returned, nullptr); // unwritten ranges take no disk space
+
+	HANDLE section = CreateFileMappingA(file, nullptr, PAGE_READWRITE, static_cast<DWORD>(static_cast<uint64_t>(length) >> 32), static_cast<DWORD>(length & 0xFFFFFFFF), nullptr);
+	void* block = section ? MapViewOfFile(section, FILE_MAP_ALL_ACCESS, 0, 0, length) : nullptr;
+	if (!block) {
+		std::cerr << "ERROR: Couldn't map " << (length >> 20) << " MB of backing file " << path << std::endl;
+		if (section) CloseHandle(section);
+		CloseHandle(file);
+		return nullptr;
+	}
+
+	mapping = {block, length, PageKind::File, file, section};
+	return block;
+#elif defined(__unix__) || defined(__APPLE__)
+	std::string pattern = directory + "/gol-grid-XXXXXX";
+	std::vector<char> path(pattern.begin(), pattern.end());
+	path.push_back('\0');
+
+	int file = mkstemp(path.data());
+	if (file < 0) {
+		std::cerr << "ERROR: Couldn't create a backing file in " << directory << std::endl;
+		return nullptr;
+	}
+	unlink(path.data()); // the mapping keeps it alive, nothing is left behind if the process dies
+
+	void* block = MAP_FAILED;
+	if (ftruncate(file, static_cast<off_t>(length)) == 0) {
+		block = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+	} // a truncated file is sparse, it reads as zeros and takes space only where written
+	close(file);
+
+	if (block == MAP_FAILED) {
+		std::cerr << "ERROR: Couldn't map " << (length >> 20) << " MB of backing file in " << directory << std::endl;
+		return nullptr;
+	}
+
+	mapping = {block, length, PageKind::File};
+	return block;
+#else
+	(void)length;
+	(void)directory;
+	(void)mapping;
+	return nullptr;
+#endif
+}
+
+void GridArena::addStats(const Mapping& mapping, bool add) {
+	size_t* counter = &GridArena::stats.normal_bytes;
+	switch (mapping.kind) {
+	case PageKind::Huge: counter = &GridArena::stats.huge_bytes; break;
+	case PageKind::Transparent: counter = &GridArena::stats.transparent_bytes; break;
+	case PageKind::File: counter = &GridArena::stats.file_bytes; break;
+	default: break;
+	}
+	*counter = add ? *counter + mapping.length : *counter - mapping.length;
+	if (add) {
+		GridArena::updatePeak();
+	}
+}
+
+void GridArena::updatePeak() {
+	GridArena::stats.peak_bytes = std::max(GridArena::stats.peak_bytes, GridArena::stats.total());
+}
+
+void GridArena::unmap(const Mapping& mapping) {
+#if defined(_WIN32)
+	if (mapping.kind == PageKind::File) {
+		UnmapViewOfFile(mapping.base);
+		CloseHandle(mapping.section);
+		CloseHandle(mapping.file);
+		return;
+	} // the file is deleted with its last handle
+	VirtualFree(mapping.base, 0, MEM_RELEASE);
+#elif defined(__unix__) || defined(__APPLE__)
+	munmap(mapping.base, mapping.length);
+#else
+	(void)mapping;
+#endif
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// memory for grid buffers, every block starts on a cache line
+// large blocks are mapped straight from the os, 2MB aligned and backed by huge pages when the platform gives them,
+// which keeps a big board's page table small enough for the tlb; when it doesn't they fall back to normal pages
+// with a backing directory set, large blocks are mapped from sparse files there instead, so boards can be bigger than ram:
+// the os keeps the pages being stepped resident and writes the rest out, and pages nobody wrote never take space at all
+class GridArena {
+public:
+	enum class PageKind {
+		Heap, // small block from the aligned heap
+		Normal, // mapped with normal pages
+		Transparent, // mapped and handed to the kernel's transparent huge pages
+		Huge, // mapped with explicit huge pages
+		File // mapped from a file in the backing directory
+	};
+
+	struct Stats {
+		size_t heap_bytes = 0;
+		size_t normal_bytes = 0;
+		size_t transparent_bytes = 0;
+		size_t huge_bytes = 0;
+		size_t file_bytes = 0;
+		size_t peak_bytes = 0; // most bytes allocated at once, of all kinds, since the last resetPeak
+
+		size_t total() const {
+			return this->heap_bytes + this->normal_bytes + this->transparent_bytes + this->huge_bytes + this->file_bytes;
+		}
+	};
+
+	static void* allocate(size_t bytes); // nullptr if the memory isn't available
+	static void release(void* pointer, size_t bytes);
+	static void setHugePages(bool enabled); // on by default, blocks allocated from now on use normal pages when off
+	static bool getHugePages();
+	// empty keeps grids in memory, only affects blocks allocated from now on
+	// a file-backed board only stays cheap if steps leave settled pages alone: Universe always steps it with the tile stepper,
+	// which skips settled tiles, and neither records history for it nor publishes it for rendering, since both read the whole board
+	static void setBackingDirectory(const std::string& directory);
+	static std::string getBackingDirectory();
+	static PageKind getKind(const void* pointer); // kind of page a block returned by allocate lives on
+	static Stats getStats(); // bytes currently allocated, by kind of page
+	static void resetPeak(); // start the peak over from what's allocated now
+	static const char* getKindName(PageKind kind);
+
+	static constexpr size_t CACHE_LINE = 64;
+	static constexpr size_t HUGE_PAGE = 2 * 1024 * 1024;
+	static constexpr size_t MAP_THRESHOLD = HUGE_PAGE; // smaller blocks wouldn't fill a huge page
+
+private:
+	struct Mapping {
+		void* base; // what the os returned, the block may start later for alignment
+		size_t length;
+		PageKind kind;
+		void* file = nullptr; // windows keeps the file and mapping handles open until the view is unmapped
+		void* section = nullptr;
+	};
+
+	// ---- methods ----
+	static void* map(size_t bytes, Mapping& mapping);
+	static void* mapFile(size_t bytes, const std::string& directory, Mapping& mapping);
+	static void addStats(const Mapping& mapping, bool add);
+	static void updatePeak(); // after anything is added, mutex is held
+	static void unmap(const Mapping& mapping);
+
+	// ---- attributes ----
+	static std::mutex mutex; // guards mappings and stats, blocks are few and large so it's never contended
+	static std::unordered_map<void*, Mapping> mappings;
+	static Stats stats;
+	static std::atomic<bool> huge_pages;
+	static std::string backing_directory; // guarded by mutex
+};
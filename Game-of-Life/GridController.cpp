@@ -1,4 +1,11 @@
 #include "GridController.h"
+#include "Census.h"
+#include "Profiler.h"
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
 
 void GridController::handleInput(const SDL_Event& event, int width, int height) {
     int mouse_x, mouse_y;
@@ -35,6 +42,7 @@ void GridController::handleInput(const SDL_Event& event, int width, int height)
 void GridController::handleMouseInsideUI(int mouse_x, int mouse_y) {
     SDL_ShowCursor(SDL_ENABLE);
     this->grid_view->setBrushPosition(-1, -1); // unset brush
+    this->grid_view->endStroke(); // a stroke that comes back from the panel starts over where it comes back
 }
 
 void GridController::handleMouseWheel(const SDL_Event& event, int mouse_x, int mouse_y, int width, int height) {
@@ -63,33 +71,232 @@ void GridController::handleMouseButton(const SDL_Event& event, int mouse_x, int
         }
     } else if (event.button.button == SDL_BUTTON_LEFT || event.button.button == SDL_BUTTON_RIGHT) {
         CellState new_state = (event.button.button == SDL_BUTTON_LEFT) ? CellState::Alive : CellState::Dead;
-        if (event.type == SDL_MOUSEBUTTONDOWN) {
+        bool shift = SDL_GetModState() & KMOD_SHIFT;
+        if (this->grid_view->isSelecting()) {
+            if (event.type == SDL_MOUSEBUTTONUP) {
+                this->grid_view->stopSelecting(); // finish the selection if button up
+            }
+        } else if (shift && event.button.button == SDL_BUTTON_LEFT && event.type == SDL_MOUSEBUTTONDOWN && !this->grid_view->isPasting()) {
+            this->grid_view->startSelecting(mouse_x, mouse_y); // start selecting if left button down while holding shift
+        } else if (this->grid_view->isPasting()) {
+            if (event.type == SDL_MOUSEBUTTONDOWN && event.button.button == SDL_BUTTON_LEFT) {
+                this->grid_view->placePaste(); // stamp the pattern if left button down while pasting
+            } else if (event.type == SDL_MOUSEBUTTONDOWN) {
+                this->grid_view->stopPasting(); // cancel pasting if right button down
+            }
+        } else if (event.type == SDL_MOUSEBUTTONDOWN) {
+            this->grid_view->endStroke(); // a press never joins the previous stroke
             this->grid_view->setStateAtBrush(new_state);
             this->grid_view->startDrawing(); // start drawing if left/right button down
         } else if (event.type == SDL_MOUSEBUTTONUP) {
             this->grid_view->stopDrawing(); // stop drawing if left/right button up
+            this->grid_view->endStroke();
         }
     }
 }
 
 void GridController::handleMouseMotion(const SDL_Event& event, int mouse_x, int mouse_y, int width, int height) {
-    if (event.motion.state & SDL_BUTTON_LMASK) {
+    this->grid_view->setBrushPosition(mouse_x, mouse_y); // change brush position to mouse position, before painting so the stroke reaches it
+
+    if (this->grid_view->isSelecting()) {
+        this->grid_view->updateSelecting(mouse_x, mouse_y); // drag the selection's corner
+    } else if (this->grid_view->isPasting()) {
+        // the stamp only follows the mouse, it's placed on clicks
+    } else if (event.motion.state & SDL_BUTTON_LMASK) {
         this->grid_view->setStateAtBrush(CellState::Alive); 
     } else if (event.motion.state & SDL_BUTTON_RMASK) {
         this->grid_view->setStateAtBrush(CellState::Dead);
-    } // if left/right button down and mouse moves
+    } // if left/right button down and mouse moves, paint the line from the last position as one edit
 
     if (event.motion.state & SDL_BUTTON_MMASK) {
         this->grid_view->updateDrag(mouse_x, mouse_y, width, height);
     } // if scroll button down and mouse moves, pan around the simulation_grid
-
-    this->grid_view->setBrushPosition(mouse_x, mouse_y); // change brush position to mouse position
 }
 
 void GridController::handleKeyPress(const SDL_Event& event) {
-    if (event.key.keysym.sym == SDLK_RIGHTBRACKET) {
+    if (this->grid_view->isPasting() && !(event.key.keysym.mod & KMOD_CTRL)) {
+        this->handlePasteKeyPress(event);
+        return;
+    } // the stamp takes r, f, m and escape while it follows the cursor
+
+    if (this->handleSelectionKeyPress(event)) {
+        return;
+    } // keys for the selected region
+
+    if (event.key.keysym.sym == SDLK_a && (event.key.keysym.mod & KMOD_CTRL)) {
+        this->grid_view->selectAll(); // select the whole board if user presses ctrl + a
+    } else if (event.key.keysym.sym == SDLK_v && (event.key.keysym.mod & KMOD_CTRL)) {
+        this->pasteFromClipboard(); // paste a pattern from the clipboard if user presses ctrl + v
+    } else if (event.key.keysym.sym == SDLK_p) {
+        this->pasteFromFile(); // paste a pattern from a file if user presses p
+    } else if (event.key.keysym.sym == SDLK_RIGHTBRACKET) {
         this->grid_view->increaseBrushSize(); // increase brush size if user presses ]
     } else if (event.key.keysym.sym == SDLK_LEFTBRACKET) {
         this->grid_view->decreaseBrushSize(); // decrease brush size if user presses [
+    } else if (event.key.keysym.sym == SDLK_LEFT) {
+        uint64_t generation = this->universe->getGeneration();
+        if (generation > 0) {
+            this->universe->rewind(generation - 1); // step back one generation if user presses left arrow
+        }
+    } else if (event.key.keysym.sym == SDLK_c && !(event.key.keysym.mod & KMOD_CTRL)) {
+        this->takeCensus(); // count the objects on the board if user presses c
+    } else if (event.key.keysym.sym == SDLK_t) {
+        Profiler& profiler = Profiler::instance();
+        if (profiler.isTracing()) {
+            this->saveTrace(); // write the trace and its summary if user presses t again
+        } else {
+            profiler.startTrace(); // start recording a trace if user presses t
+            this->ui_ctrl->showMessage({"Recording a trace, press 't' again to save it"});
+        }
+    } else if (event.key.keysym.sym == SDLK_h) {
+        this->ui_ctrl->toggleHud(); // show or hide the performance overlay if user presses h
+    }
+}
+
+void GridController::takeCensus() {
+    Census census;
+    census.run(*this->universe);
+
+    std::vector<std::string> lines = {"Census of generation " + std::to_string(this->universe->getGeneration()) + ": " + std::to_string(census.getObjectCount()) + " objects"};
+    const std::vector<Census::Entry>& entries = census.getEntries();
+    for (size_t i = 0; i < entries.size() && i < 5; i++) {
+        const Census::Entry& entry = entries[i];
+        std::string name = entry.name.empty() ? std::to_string(entry.population) + " cell " + std::to_string(entry.width) + "x" + std::to_string(entry.height) + " object" : entry.name;
+        lines.push_back(std::to_string(entry.count) + " x " + name);
+    } // the most common objects, the rest are in the file
+
+    std::ofstream file("census.csv");
+    if (file.is_open()) {
+        census.write(file);
+        lines.push_back("Saved the full table to " + std::filesystem::absolute("census.csv").string());
+    } else {
+        lines.push_back("Couldn't save the full table to census.csv");
+    }
+    this->ui_ctrl->showMessage(lines);
+}
+
+void GridController::saveTrace() {
+    Profiler& profiler = Profiler::instance();
+    std::vector<std::string> lines;
+    if (profiler.stopTrace("trace.json")) {
+        lines.push_back("Saved the trace to " + std::filesystem::absolute("trace.json").string());
+    } else {
+        lines.push_back("Couldn't save the trace to trace.json");
+    }
+
+    std::ofstream file("trace-summary.txt");
+    if (file.is_open()) {
+        profiler.writeSummary(file);
+        lines.push_back("Saved the timing summary to " + std::filesystem::absolute("trace-summary.txt").string());
+    } else {
+        lines.push_back("Couldn't save the timing summary to trace-summary.txt");
+    }
+    this->ui_ctrl->showMessage(lines);
+}
+
+void GridController::handlePasteKeyPress(const SDL_Event& event) {
+    bool shift = event.key.keysym.mod & KMOD_SHIFT;
+
+    if (event.key.keysym.sym == SDLK_r) {
+        this->grid_view->rotatePaste(!shift); // rotate clockwise if user presses r, counterclockwise with shift
+    } else if (event.key.keysym.sym == SDLK_f) {
+        this->grid_view->flipPaste(!shift); // mirror left to right if user presses f, top to bottom with shift
+    } else if (event.key.keysym.sym == SDLK_m) {
+        this->grid_view->cyclePasteMode(); // switch between or, xor and replace if user presses m
+    } else if (event.key.keysym.sym == SDLK_ESCAPE) {
+        this->grid_view->stopPasting(); // cancel pasting if user presses escape
     }
 }
+
+bool GridController::handleSelectionKeyPress(const SDL_Event& event) {
+    int x, y, width, height;
+    if (!this->grid_view->getSelection(x, y, width, height)) return false; // nothing selected
+
+    bool ctrl = event.key.keysym.mod & KMOD_CTRL;
+    SDL_Keycode key = event.key.keysym.sym;
+
+    if (ctrl && key == SDLK_c) {
+        this->copySelection(); // copy the selection if user presses ctrl + c
+    } else if (ctrl && key == SDLK_x) {
+        if (this->copySelection()) {
+            this->universe->clearRegion(x, y, width, height); // copy then clear the selection if user presses ctrl + x
+        } // a failed copy keeps the cells, nothing else holds them
+    } else if (key == SDLK_DELETE || key == SDLK_BACKSPACE) {
+        this->universe->clearRegion(x, y, width, height); // kill every cell in the selection if user presses delete
+    } else if (!ctrl && key == SDLK_i) {
+        this->universe->invertRegion(x, y, width, height); // invert the selection if user presses i
+    } else if (!ctrl && key == SDLK_n) {
+        this->universe->randomizeRegion(x, y, width, height, this->ui_ctrl->getRandomPercent(), std::random_device()()); // fill the selection with random cells at the randomize percentage if user presses n
+    } else if (key == SDLK_ESCAPE) {
+        this->grid_view->clearSelection(); // forget the selection if user presses escape
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool GridController::copySelection() {
+    int x, y, width, height;
+    if (!this->grid_view->getSelection(x, y, width, height)) return false; // exit if nothing is selected
+
+    Stamp stamp = this->universe->copyRegion(x, y, width, height);
+    if (stamp.empty()) {
+        this->ui_ctrl->showMessage({"Couldn't copy the selection", "It isn't on the board, or a copy of it wouldn't fit the memory budget"});
+        return false;
+    } // exit if the region couldn't be copied
+
+    uint64_t length = PatternFile::getCellsLength(stamp.getCells(), "");
+    if (length > MAX_CLIPBOARD_TEXT) {
+        std::ostringstream note;
+        note << "!A " << stamp.getWidth() << " x " << stamp.getHeight() << " selection copied in Game of Life, too large for the clipboard\n";
+        this->copied = std::move(stamp);
+        this->copied_text = note.str(); // still tells ctrl + v to paste the stamp
+        SDL_SetClipboardText(this->copied_text.c_str());
+        this->ui_ctrl->showMessage({"Copied the selection for pasting here",
+            "As text it would take " + std::to_string(length >> 20) + " MB, so other programs didn't get the pattern"});
+        return true;
+    } // a byte per cell would be gigabytes for a large selection
+
+    std::ostringstream text;
+    PatternFile::writeCells(text, stamp.getCells(), "");
+    this->copied = std::move(stamp);
+    this->copied_text = text.str();
+    SDL_SetClipboardText(this->copied_text.c_str()); // other programs get the live cells, trimmed like any .cells file
+    return true;
+}
+
+void GridController::pasteFromClipboard() {
+    if (!SDL_HasClipboardText()) {
+        this->ui_ctrl->showMessage({"The clipboard has no pattern to paste"});
+        return;
+    } // exit if nothing to paste
+
+    char* text = SDL_GetClipboardText();
+    if (!this->copied.empty() && this->copied_text == text) {
+        SDL_free(text);
+        this->grid_view->startPasting(this->copied);
+        return;
+    } // our own copy keeps its dead edges, which the text trims
+
+    Stamp stamp;
+    bool loaded = stamp.loadFromText(text, this->universe->getMemoryBudget());
+    SDL_free(text);
+
+    if (loaded && !stamp.empty()) {
+        this->grid_view->startPasting(std::move(stamp));
+    } else {
+        this->ui_ctrl->showMessage({"The clipboard text isn't a pattern that fits the memory budget"});
+    } // keep the board as it is if the text isn't a pattern
+}
+
+void GridController::pasteFromFile() {
+    std::string filename = this->ui_ctrl->choosePatternFile();
+    if (filename.empty()) return; // exit if dialog was cancelled
+
+    Stamp stamp;
+    if (stamp.loadFromFile(filename, this->universe->getMemoryBudget()) && !stamp.empty()) {
+        this->grid_view->startPasting(std::move(stamp));
+    } else {
+        this->ui_ctrl->showMessage({"Couldn't paste " + filename, "It isn't a pattern that fits the memory budget, or it has no live cells"});
+    } // keep the board as it is if the file isn't a pattern
+}
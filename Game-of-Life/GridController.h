@@ -13,9 +13,20 @@ private:
 	void handleMouseButton(const SDL_Event& event, int mouse_x, int mouse_y);
 	void handleMouseMotion(const SDL_Event& event, int mouse_x, int mouse_y, int width, int height);
 	void handleKeyPress(const SDL_Event& event);
+	void takeCensus(); // shown in the window and written to census.csv
+	void saveTrace(); // trace.json and trace-summary.txt next to it, the paths are shown in the window
+	void handlePasteKeyPress(const SDL_Event& event); // keys that turn and place the stamp while pasting
+	bool handleSelectionKeyPress(const SDL_Event& event); // returns whether the key acted on the selection
+	bool copySelection(); // to the clipboard as .cells text, and kept as a stamp for pasting here, false with a message shown if it couldn't be copied
+	void pasteFromClipboard(); // any pattern format as text, e.g. copied from a pattern collection
+	void pasteFromFile();
 
 	GridView* grid_view;
 	UIController* ui_ctrl;
 	Universe* universe;
+	Stamp copied; // last copy, pasted as is while the clipboard still holds its text
+	std::string copied_text;
+
+	static constexpr uint64_t MAX_CLIPBOARD_TEXT = 16 * 1024 * 1024; // bytes, larger copies only stay in the game
 };
 
@@ -1,5 +1,8 @@
 #include "GridView.h"
+#include "ResourceCache.h"
+#include "Profiler.h"
 #include <algorithm>
+#include <cstdlib>
 #include <iostream>
 
 GridView::GridView(Universe* universe) {
@@ -15,84 +18,90 @@ GridView::GridView(Universe* universe) {
 	this->brush_size = 1;
 	this->brush_x = -1;
 	this->brush_y = -1;
+	this->has_stroke = false;
+	this->stroke_x = 0;
+	this->stroke_y = 0;
 	this->window_width = 800;
 	this->window_height = 600;
+	this->is_selecting = false;
+	this->has_selection = false;
+	this->selection_start_x = 0;
+	this->selection_start_y = 0;
+	this->selection_end_x = 0;
+	this->selection_end_y = 0;
+	this->is_pasting = false;
+	this->paste_mode = StampMode::Or;
 	this->recenter();
 }
 
 #pragma region Rendering
 void GridView::render(SDL_Renderer* renderer, Universe& universe, int ui_panel_width) {
-	// capture a snapshot of the current simulation_grid state
-	int rows, cols;
-	std::vector<std::vector<CellState>> grid_snapshot;
-
-	{
-		grid_snapshot = universe.getRenderingGrid();
-
-		// lock simulation_grid while taking a snapshot to prevent any other thread from modifying it
-		std::lock_guard<std::mutex> lock(universe.grid_mutex);
-		if (grid_snapshot.empty()) {
+	PROFILE_SCOPE("GridView::render");
+	// draw straight from the published grid while it's locked, the simulation thread only waits on this for a swap
+	universe.readRenderingGrid([&](const BitGrid& grid) {
+		if (grid.empty()) {
 			return;
 		}
-		rows = grid_snapshot.size();
-		cols = grid_snapshot.front().size();
-	}
-
-	SDL_SetRenderDrawColor(renderer, 200, 211, 180, 255); // simulation_grid line color
-	int render_width = this->window_width - ui_panel_width; // don't render a simulation_grid in ui panel area
-	int render_height = this->window_height;
-
-
-	// render vertical simulation_grid lines
-	for (int x = 0; x <= cols; x++) {
-		int screen_x = this->offset_x + x * this->cell_size;
-		if (screen_x < 0 || screen_x >= render_width) continue; // Skip lines out of render bounds
-		SDL_RenderDrawLine(renderer, screen_x, this->offset_y, screen_x, this->offset_y + rows * this->cell_size);
-	}
+		int rows = grid.getHeight();
+		int cols = grid.getWidth();
+
+		int render_width = this->window_width - ui_panel_width; // don't render a simulation_grid in ui panel area
+		int render_height = this->window_height;
+
+		// only visit the rows and columns that are on screen
+		auto firstVisible = [this](int offset) {
+			return offset >= 0 ? 0 : -offset / this->cell_size;
+		};
+		auto lastVisible = [this](int offset, int extent, int count) {
+			if (offset >= extent) return -1; // entirely past the render area
+			return std::min(count - 1, (extent - 1 - offset) / this->cell_size);
+		};
+
+		int first_col = firstVisible(this->offset_x);
+		int last_col = lastVisible(this->offset_x, render_width, cols);
+		int first_row = firstVisible(this->offset_y);
+		int last_row = lastVisible(this->offset_y, render_height, rows);
+
+		SDL_SetRenderDrawColor(renderer, 200, 211, 180, 255); // simulation_grid line color
+
+		// render vertical simulation_grid lines
+		for (int x = first_col; x <= std::min(last_col + 1, cols); x++) {
+			int screen_x = this->offset_x + x * this->cell_size;
+			if (screen_x < 0 || screen_x >= render_width) continue; // Skip lines out of render bounds
+			SDL_RenderDrawLine(renderer, screen_x, this->offset_y, screen_x, this->offset_y + rows * this->cell_size);
+		}
 
-	// render horizontal simulation_grid lines
-	for (int y = 0; y <= rows; y++) {
-		int screen_y = this->offset_y + y * this->cell_size;
-		if (screen_y < 0 || screen_y >= render_height) continue; // Skip lines out of render bounds
-		SDL_RenderDrawLine(renderer, this->offset_x, screen_y, this->offset_x + cols * this->cell_size, screen_y);
-	}
+		// render horizontal simulation_grid lines
+		for (int y = first_row; y <= std::min(last_row + 1, rows); y++) {
+			int screen_y = this->offset_y + y * this->cell_size;
+			if (screen_y < 0 || screen_y >= render_height) continue; // Skip lines out of render bounds
+			SDL_RenderDrawLine(renderer, this->offset_x, screen_y, this->offset_x + cols * this->cell_size, screen_y);
+		}
 
-	// render alive cells
-	try {
-		for (int row = 0; row < rows; row++) {
-			for (int col = 0; col < cols; col++) {
-				// calculate screen position
-				int screen_x = this->offset_x + col * this->cell_size;
-				int screen_y = this->offset_y + row * this->cell_size;
-
-				// skip cells out of bounds
-				if (screen_x + this->cell_size <= 0 || screen_x >= render_width ||
-					screen_y + this->cell_size <= 0 || screen_y >= render_height) {
-					continue;
-				}
+		// render alive cells
+		try {
+			SDL_SetRenderDrawColor(renderer, 252, 197, 45, 255); // alive cell color (yellow)
 
-				// render if cell is in bounds
-				if (row >= 0 && row < grid_snapshot.size() &&
-					col >= 0 && col < grid_snapshot[row].size()) {
-					if (grid_snapshot[row][col] == CellState::Alive) {
+			for (int row = first_row; row <= last_row; row++) {
+				for (int col = first_col; col <= last_col; col++) {
+					if (grid.isAlive(col, row)) {
 						SDL_Rect cell_rect = {
-							screen_x,
-							screen_y,
+							this->offset_x + col * this->cell_size,
+							this->offset_y + row * this->cell_size,
 							this->cell_size,
 							this->cell_size
 						};
 
-						SDL_SetRenderDrawColor(renderer, 252, 197, 45, 255); // alive cell color (yellow)
 						SDL_RenderFillRect(renderer, &cell_rect);
 					}
 				}
 			}
+		} catch (const std::exception& e) {
+			std::cerr << "ERROR: Grid rendering error: " << e.what() << std::endl;
+		} catch (...) {
+			std::cerr << "ERROR: Unknown grid rendering error" << std::endl;
 		}
-	} catch (const std::exception& e) {
-		std::cerr << "ERROR: Grid rendering error: " << e.what() << std::endl;
-	} catch (...) {
-		std::cerr << "ERROR: Unknown grid rendering error" << std::endl;
-	}
+	});
 }
 
 int GridView::getCellSize() {
@@ -206,25 +215,60 @@ void GridView::setCellState(int mouse_x, int mouse_y, CellState state) {
 void GridView::setStateAtBrush(CellState state) {
 	if (this->brush_x == -1 || this->brush_y == -1) return; // exit if brush is not set
 
-	// get brush simulation_grid coordinates
-	int brush_left = this->brush_x - this->cell_size * this->brush_size / 2;
-	int brush_top = this->brush_y - this->cell_size * this->brush_size / 2;
-
-	// set cell states covered by brush
-	for (int x = 0; x < this->brush_size; ++x) {
-		for (int y = 0; y < this->brush_size; ++y) {
-			// get cell coordinates
-			int cell_x = (brush_left + x * this->cell_size - this->offset_x) / this->cell_size;
-			int cell_y = (brush_top + y * this->cell_size - this->offset_y) / this->cell_size;
-
-			// set cell states if in bounds
-			if (cell_x >= 0 && cell_x < this->universe->getWidth() &&
-				cell_y >= 0 && cell_y < this->universe->getHeight()) {
-				this->universe->setCellState(cell_x, cell_y, state);
+	// get the top left cell of the brush's footprint
+	int cell_x, cell_y;
+	this->getCellAt(this->brush_x - this->cell_size * this->brush_size / 2, this->brush_y - this->cell_size * this->brush_size / 2, cell_x, cell_y);
+
+	// rasterize the line from the stroke's last stamp with bresenham, so fast drags don't leave gaps
+	int x = this->has_stroke ? this->stroke_x : cell_x;
+	int y = this->has_stroke ? this->stroke_y : cell_y;
+	int dx = std::abs(cell_x - x), dy = -std::abs(cell_y - y);
+	int step_x = x < cell_x ? 1 : -1, step_y = y < cell_y ? 1 : -1;
+	int error = dx + dy;
+
+	int width = this->universe->getWidth(), height = this->universe->getHeight();
+	this->stroke_cells.clear();
+	while (true) {
+		// stamp the brush's footprint at every point of the line
+		for (int row = std::max(y, 0); row < std::min(y + this->brush_size, height); row++) {
+			for (int col = std::max(x, 0); col < std::min(x + this->brush_size, width); col++) {
+				this->stroke_cells.push_back(CellEdit{col, row, state});
 			}
+		} // only cells on the board
+
+		if (x == cell_x && y == cell_y) break;
+		int doubled = 2 * error;
+		if (doubled >= dy) {
+			error += dy;
+			x += step_x;
+		}
+		if (doubled <= dx) {
+			error += dx;
+			y += step_y;
 		}
 	}
+
+	this->has_stroke = true;
+	this->stroke_x = cell_x;
+	this->stroke_y = cell_y;
+
+	// neighbouring footprints overlap, each cell only needs to be sent once
+	std::sort(this->stroke_cells.begin(), this->stroke_cells.end(), [](const CellEdit& a, const CellEdit& b) {
+		return a.y != b.y ? a.y < b.y : a.x < b.x;
+	});
+	this->stroke_cells.erase(std::unique(this->stroke_cells.begin(), this->stroke_cells.end(), [](const CellEdit& a, const CellEdit& b) {
+		return a.x == b.x && a.y == b.y;
+	}), this->stroke_cells.end());
+
+	EditBatch batch;
+	batch.cells.assign(this->stroke_cells.begin(), this->stroke_cells.end());
+	this->universe->submitEdit(std::move(batch)); // one queue push per motion event, applied between generations
+}
+
+void GridView::endStroke() {
+	this->has_stroke = false;
 }
+
 void GridView::startDrawing() {
 	this->is_drawing = true;
 }
@@ -241,6 +285,8 @@ void GridView::setBrushPosition(int mouse_x, int mouse_y) {
 void GridView::renderBrush(SDL_Renderer* renderer) {
 	if (this->brush_x == -1 || this->brush_y == -1) return; // exit if brush is not set
 
+	if (this->is_pasting) return; // the stamp's outline stands in for the brush
+
 	if (this->brush_x >= this->window_width - this->window_width / 4) return; // exit if cursor is inside ui side panel
 
 	// get brush simulation_grid coordinates
@@ -272,4 +318,200 @@ bool GridView::isDrawing() {
 	return this->is_drawing;
 }
 
+#pragma endregion
+
+#pragma region Selection
+void GridView::startSelecting(int mouse_x, int mouse_y) {
+	this->getCellAt(mouse_x, mouse_y, this->selection_start_x, this->selection_start_y);
+	this->selection_end_x = this->selection_start_x;
+	this->selection_end_y = this->selection_start_y;
+	this->is_selecting = true;
+	this->has_selection = true;
+}
+
+void GridView::updateSelecting(int mouse_x, int mouse_y) {
+	if (!this->is_selecting) return;
+	this->getCellAt(mouse_x, mouse_y, this->selection_end_x, this->selection_end_y);
+}
+
+void GridView::stopSelecting() {
+	this->is_selecting = false;
+}
+
+void GridView::selectAll() {
+	this->selection_start_x = 0;
+	this->selection_start_y = 0;
+	this->selection_end_x = this->universe->getWidth() - 1;
+	this->selection_end_y = this->universe->getHeight() - 1;
+	this->is_selecting = false;
+	this->has_selection = true;
+}
+
+void GridView::clearSelection() {
+	this->is_selecting = false;
+	this->has_selection = false;
+}
+
+bool GridView::isSelecting() {
+	return this->is_selecting;
+}
+
+bool GridView::getSelection(int& x, int& y, int& width, int& height) {
+	if (!this->has_selection) return false;
+
+	// clip the corners to the board, the board may have been resized since they were picked
+	int left = std::max(std::min(this->selection_start_x, this->selection_end_x), 0);
+	int top = std::max(std::min(this->selection_start_y, this->selection_end_y), 0);
+	int right = std::min(std::max(this->selection_start_x, this->selection_end_x), this->universe->getWidth() - 1);
+	int bottom = std::min(std::max(this->selection_start_y, this->selection_end_y), this->universe->getHeight() - 1);
+	if (left > right || top > bottom) return false; // entirely off the board
+
+	x = left;
+	y = top;
+	width = right - left + 1;
+	height = bottom - top + 1;
+	return true;
+}
+
+void GridView::renderSelection(SDL_Renderer* renderer) {
+	int x, y, width, height;
+	if (!this->getSelection(x, y, width, height)) return; // exit if nothing is selected
+
+	// clamp to just past the render area, a selection of a large board can be far wider than the screen
+	int render_width = this->window_width - this->window_width / 4;
+	int64_t left = std::max<int64_t>(this->offset_x + int64_t(x) * this->cell_size, -1);
+	int64_t top = std::max<int64_t>(this->offset_y + int64_t(y) * this->cell_size, -1);
+	int64_t right = std::min<int64_t>(this->offset_x + int64_t(x + width) * this->cell_size, render_width + 1);
+	int64_t bottom = std::min<int64_t>(this->offset_y + int64_t(y + height) * this->cell_size, this->window_height + 1);
+	if (left >= right || top >= bottom) return; // exit if off screen
+
+	SDL_Rect area = {static_cast<int>(left), static_cast<int>(top), static_cast<int>(right - left), static_cast<int>(bottom - top)};
+	SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+	SDL_SetRenderDrawColor(renderer, 120, 170, 255, 50); // see-through so the cells show under it
+	SDL_RenderFillRect(renderer, &area);
+	SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+
+	SDL_SetRenderDrawColor(renderer, 120, 170, 255, 255); // selection outline color
+	SDL_RenderDrawRect(renderer, &area);
+}
+
+void GridView::getCellAt(int mouse_x, int mouse_y, int& cell_x, int& cell_y) {
+	int grid_x = mouse_x - this->offset_x, grid_y = mouse_y - this->offset_y;
+	cell_x = grid_x >= 0 ? grid_x / this->cell_size : -((this->cell_size - 1 - grid_x) / this->cell_size);
+	cell_y = grid_y >= 0 ? grid_y / this->cell_size : -((this->cell_size - 1 - grid_y) / this->cell_size);
+}
+#pragma endregion
+
+#pragma region Pasting
+void GridView::startPasting(Stamp stamp) {
+	this->paste_stamp = std::move(stamp);
+	this->is_pasting = true;
+	this->is_drawing = false;
+}
+
+void GridView::stopPasting() {
+	this->is_pasting = false;
+	this->paste_stamp = Stamp(); // a pasted board can be large, don't hold on to it
+}
+
+bool GridView::isPasting() {
+	return this->is_pasting;
+}
+
+void GridView::placePaste() {
+	int cell_x, cell_y;
+	if (!this->is_pasting || !this->getPastePosition(cell_x, cell_y)) return; // exit if brush is not set
+
+	this->universe->stamp(this->paste_stamp, cell_x, cell_y, this->paste_mode); // one masked copy per row of the stamp
+}
+
+void GridView::rotatePaste(bool clockwise) {
+	if (clockwise) {
+		this->paste_stamp.rotateClockwise();
+	} else {
+		this->paste_stamp.rotateCounterClockwise();
+	}
+}
+
+void GridView::flipPaste(bool horizontal) {
+	if (horizontal) {
+		this->paste_stamp.flipHorizontal();
+	} else {
+		this->paste_stamp.flipVertical();
+	}
+}
+
+void GridView::cyclePasteMode() {
+	switch (this->paste_mode) {
+	case StampMode::Or: this->paste_mode = StampMode::Xor; break;
+	case StampMode::Xor: this->paste_mode = StampMode::Replace; break;
+	case StampMode::Replace: this->paste_mode = StampMode::Or; break;
+	}
+} // renderPaste shows the mode next to the stamp
+
+void GridView::renderPaste(SDL_Renderer* renderer) {
+	int cell_x, cell_y;
+	if (!this->is_pasting || !this->getPastePosition(cell_x, cell_y)) return; // exit if brush is not set
+
+	int render_width = this->window_width - this->window_width / 4; // don't render over the ui side panel
+	if (this->brush_x >= render_width) return; // exit if cursor is inside ui side panel
+
+	const BitGrid& cells = this->paste_stamp.getCells();
+	int left = this->offset_x + cell_x * this->cell_size;
+	int top = this->offset_y + cell_y * this->cell_size;
+
+	// only visit the stamp's rows and columns that are on screen
+	int first_col = std::max(0, -left / this->cell_size);
+	int last_col = std::min(cells.getWidth() - 1, (render_width - 1 - left) / this->cell_size);
+	int first_row = std::max(0, -top / this->cell_size);
+	int last_row = std::min(cells.getHeight() - 1, (this->window_height - 1 - top) / this->cell_size);
+
+	SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+	SDL_SetRenderDrawColor(renderer, 0, 150, 150, 160); // live cells of the stamp, see-through so the board shows under it
+	for (int row = first_row; row <= last_row; row++) {
+		for (int col = first_col; col <= last_col; col++) {
+			if (cells.isAlive(col, row)) {
+				SDL_Rect cell_rect = {left + col * this->cell_size, top + row * this->cell_size, this->cell_size, this->cell_size};
+				SDL_RenderFillRect(renderer, &cell_rect);
+			}
+		}
+	}
+	SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+
+	// render the stamp's outline where the brush would be
+	SDL_Rect outline = {left, top, cells.getWidth() * this->cell_size, cells.getHeight() * this->cell_size};
+	SDL_SetRenderDrawColor(renderer, 0, 150, 150, 255);
+	SDL_RenderDrawRect(renderer, &outline);
+
+	// render the paste mode above the outline, kept on the board when the outline runs off it
+	static const std::string font_path = UI::getExecutableDirectory() + "\\assets\\arial.ttf";
+	TTF_Font* font = UI::ResourceCache::instance().getFont(font_path, 12);
+	std::string label = std::string("paste: ") + Stamp::getModeName(this->paste_mode) + " (m to change)";
+	UI::TextTexture text = UI::ResourceCache::instance().getText(renderer, font, label, {249, 252, 223, 255}, UI::TextMode::Blended);
+	if (text.texture) {
+		int padding = 3;
+		SDL_Rect box = {left, top - text.height - 2 * padding, text.width + 2 * padding, text.height + 2 * padding};
+		box.x = std::clamp(box.x, 0, std::max(0, render_width - box.w));
+		box.y = std::clamp(box.y, 0, std::max(0, this->window_height - box.h));
+
+		SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+		SDL_SetRenderDrawColor(renderer, 26, 26, 25, 225);
+		SDL_RenderFillRect(renderer, &box);
+		SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+
+		SDL_Rect text_rect = {box.x + padding, box.y + padding, text.width, text.height};
+		SDL_RenderCopy(renderer, text.texture, nullptr, &text_rect);
+	}
+}
+
+bool GridView::getPastePosition(int& cell_x, int& cell_y) {
+	if (this->brush_x == -1 || this->brush_y == -1) return false;
+
+	int cursor_x, cursor_y;
+	this->getCellAt(this->brush_x, this->brush_y, cursor_x, cursor_y);
+
+	cell_x = cursor_x - this->paste_stamp.getWidth() / 2;
+	cell_y = cursor_y - this->paste_stamp.getHeight() / 2;
+	return true;
+}
 #pragma endregion
\ No newline at end of file
@@ -43,7 +43,8 @@ private:
 public:
 	// ---- methods ----
 	void setCellState(int mouse_x, int mouse_y, CellState state);
-	void setStateAtBrush(CellState state);
+	void setStateAtBrush(CellState state); // brush footprint along the line from the stroke's last stamp, as one edit batch
+	void endStroke(); // the next brush stamp starts a new stroke instead of joining the last one
 	void startDrawing();
 	void stopDrawing();
 	void setBrushPosition(int mouse_x, int mouse_y);
@@ -59,6 +60,57 @@ private:
 	int brush_size;
 	int brush_x;
 	int brush_y;
+	bool has_stroke; // whether stroke_x and stroke_y hold the last stamp of a stroke
+	int stroke_x; // top left cell of the last stamp's footprint
+	int stroke_y;
+	std::vector<CellEdit> stroke_cells; // reused by every stamp of a stroke
+#pragma endregion
+
+#pragma region Selection
+public:
+	// ---- methods ----
+	void startSelecting(int mouse_x, int mouse_y); // corner cell under the mouse, the opposite corner follows it until stopSelecting
+	void updateSelecting(int mouse_x, int mouse_y);
+	void stopSelecting();
+	void selectAll();
+	void clearSelection(); // forget the selection, the cells under it stay
+	bool isSelecting();
+	bool getSelection(int& x, int& y, int& width, int& height); // clipped to the board, false if nothing is selected
+	void renderSelection(SDL_Renderer* renderer);
+
+private:
+	// ---- methods ----
+	void getCellAt(int mouse_x, int mouse_y, int& cell_x, int& cell_y); // rounded down, may be off the board
+
+	// ---- attributes ----
+	bool is_selecting;
+	bool has_selection;
+	int selection_start_x; // corner cells, in either order
+	int selection_start_y;
+	int selection_end_x;
+	int selection_end_y;
+#pragma endregion
+
+#pragma region Pasting
+public:
+	// ---- methods ----
+	void startPasting(Stamp stamp); // the stamp follows the cursor until it's cancelled
+	void stopPasting();
+	bool isPasting();
+	void placePaste(); // stamp centered on the brush, pasting goes on so it can be placed again
+	void rotatePaste(bool clockwise);
+	void flipPaste(bool horizontal);
+	void cyclePasteMode(); // or, xor, replace
+	void renderPaste(SDL_Renderer* renderer);
+
+private:
+	// ---- methods ----
+	bool getPastePosition(int& cell_x, int& cell_y); // board cell under the stamp's top left corner, false if the brush is not set
+
+	// ---- attributes ----
+	Stamp paste_stamp;
+	bool is_pasting;
+	StampMode paste_mode;
 #pragma endregion
 
 private:
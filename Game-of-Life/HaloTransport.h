@@ -0,0 +1,32 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// moves halo cells between the workers of a distributed board
+// a worker only ever talks to the four workers next to its region, and messages to one neighbour arrive in the order they were sent
+// shared memory between local processes is the only transport so far, a socket or mpi transport would implement the same calls
+class HaloTransport {
+public:
+	enum Direction {
+		Up,
+		Down,
+		Left,
+		Right
+	};
+
+	virtual ~HaloTransport() = default;
+
+	virtual bool hasNeighbour(Direction direction) const = 0; // false at the edge of the board
+	virtual bool send(Direction direction, const uint64_t* words, size_t count) = 0; // returns false if the run was aborted, may block while the neighbour is behind
+	virtual bool receive(Direction direction, uint64_t* words, size_t count) = 0; // blocks until the neighbour's next message arrives, false if the run was aborted
+
+	static Direction getOpposite(Direction direction) {
+		switch (direction) {
+		case Up: return Down;
+		case Down: return Up;
+		case Left: return Right;
+		case Right: return Left;
+		}
+		return direction;
+	}
+};
@@ -0,0 +1,244 @@
+#include "LoaderFuzzer.h"
+#include "CommandLine.h"
+#include "GridArena.h"
+#include "Universe.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+LoaderFuzzer::LoaderFuzzer(const Config& config) {
+	this->config = config;
+}
+
+bool LoaderFuzzer::run() {
+	this->failures = 0;
+	std::vector<std::string> seeds = this->getSeeds();
+
+	for (const Loader& loader : LoaderFuzzer::getLoaders()) {
+		std::mt19937 random(this->config.seed);
+		std::vector<std::string> pool = seeds; // mutations of mutations reach further than mutations of the seeds alone
+		double slowest = 0.0;
+		int loader_failures = 0;
+
+		for (uint64_t i = 0; i < this->config.runs; i++) {
+			std::string input = i < seeds.size() ? seeds[i] : this->mutate(pool[random() % pool.size()], seeds, random);
+			if (pool.size() < 256) pool.push_back(input);
+			else pool[random() % pool.size()] = input;
+
+			std::string problem;
+			auto start = std::chrono::steady_clock::now();
+			bool within_limits = LoaderFuzzer::checkInput(loader, input, this->config.memory_budget, this->config.max_milliseconds, problem);
+			slowest = std::max(slowest, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+
+			if (!within_limits) {
+				loader_failures++;
+				std::cout << "FAIL " << loader.name << " input " << i << ": " << problem << std::endl;
+				this->saveInput(input, loader.name, i);
+			}
+		}
+
+		this->failures += loader_failures;
+		std::cout << loader.name << ": " << this->config.runs << " inputs, slowest " << slowest << " ms, "
+			<< (loader_failures == 0 ? "all within limits" : std::to_string(loader_failures) + " over a limit") << std::endl;
+	}
+	return this->failures == 0;
+}
+
+int LoaderFuzzer::getFailureCount() const {
+	return this->failures;
+}
+
+std::vector<LoaderFuzzer::Loader> LoaderFuzzer::getLoaders() {
+	return {
+		{"dense", [](Universe& universe, std::istream& input) { return universe.loadFromStream(input, PatternFile::Format::Dense); }},
+		{"cells", [](Universe& universe, std::istream& input) { return universe.loadFromStream(input, PatternFile::Format::Cells); }},
+		{"life106", [](Universe& universe, std::istream& input) { return universe.loadFromStream(input, PatternFile::Format::Life106); }},
+		{"detected", [](Universe& universe, std::istream& input) { return universe.loadFromStream(input, PatternFile::detectFormat("", input)); }},
+	};
+}
+
+bool LoaderFuzzer::checkInput(const Loader& loader, const std::string& input, size_t memory_budget, double max_milliseconds, std::string& problem) {
+	Universe universe(5, 5, 0);
+	universe.setMemoryBudget(memory_budget);
+	std::istringstream stream(input);
+
+	std::streambuf* out = std::cout.rdbuf(nullptr);
+	std::streambuf* err = std::cerr.rdbuf(nullptr);
+	size_t before = GridArena::getStats().total();
+	GridArena::resetPeak(); // a loader that builds a huge grid and then frees it has still gone over the budget
+	auto start = std::chrono::steady_clock::now();
+	loader.load(universe, stream);
+	double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	std::cout.rdbuf(out);
+	std::cerr.rdbuf(err);
+	std::cout.clear(); // writing to a stream without a buffer sets badbit
+	std::cerr.clear();
+
+	size_t peak = GridArena::getStats().peak_bytes - before; // grids allocated during the load, the old board's included
+	size_t memory = std::max(peak, universe.getMemoryUsage().total()); // the history's frames live outside the arena
+	if (milliseconds > max_milliseconds) {
+		problem = "took " + std::to_string(milliseconds) + " ms";
+		return false;
+	}
+	if (memory > memory_budget) {
+		problem = "held " + std::to_string(memory >> 10) + " KB, over the budget of " + std::to_string(memory_budget >> 10) + " KB";
+		return false;
+	}
+	return true;
+}
+
+std::vector<std::string> LoaderFuzzer::getSeeds() const {
+	std::vector<std::string> seeds = {
+		"5 5\n00000\n00100\n00010\n01110\n00000\n",
+		"10 3\r\n1111111111\r\n0101010101\r\n1000000001\r\n",
+		"3 3\n111\n",
+		"4 2\n1111111\n10\n1\n1\n",
+		"2147483647 2147483647\n1\n",
+		"-5 7\n",
+		"70 1\n" + std::string(70, '1') + "\n",
+		"",
+		"0 0\n",
+		"8 8\n\n\n\n00011000\nxx11yy\n",
+		"!Name: Glider\n!\n.O\n..O\nOOO\n",
+		"!comment\r\n.O.\r\n\r\n*.*\r\n",
+		"#Life 1.06\n0 -1\n1 0\n-1 1\n0 1\n1 1\n",
+		"#Life 1.06\n#D far apart\n-2147483648 0\n2147483647 0\n",
+		"#Life 1.06\n1000000 1000000\n1000002 1000001\n",
+	};
+
+	if (!this->config.corpus.empty()) {
+		std::error_code error;
+		for (const auto& entry : std::filesystem::directory_iterator(this->config.corpus, error)) {
+			if (!entry.is_regular_file()) continue;
+
+			std::ifstream file(entry.path(), std::ios::binary);
+			std::string input(this->config.max_input, '\0');
+			file.read(&input[0], static_cast<std::streamsize>(input.size()));
+			input.resize(static_cast<size_t>(file.gcount()));
+			seeds.push_back(input);
+		}
+		if (error) {
+			std::cerr << "ERROR: Couldn't read corpus directory " << this->config.corpus << std::endl;
+		}
+	} // real pattern files get the mutations into the interesting parts of the format
+
+	return seeds;
+}
+
+std::string LoaderFuzzer::mutate(const std::string& input, const std::vector<std::string>& seeds, std::mt19937& random) const {
+	static const char* numbers[] = {"0", "1", "-1", "5", "63", "64", "65", "4096", "65536", "2147483647", "2147483648", "-2147483648", "99999999999", "1e9", "0x10"};
+	static const char characters[] = "01 \n\r\t-+#!.O*bo$x=,";
+
+	std::string result = input;
+	int mutations = 1 + static_cast<int>(random() % 4);
+	for (int m = 0; m < mutations; m++) {
+		size_t position = result.empty() ? 0 : random() % (result.size() + 1);
+		switch (random() % 8) {
+		case 0: // flip a bit
+			if (!result.empty()) result[position % result.size()] ^= static_cast<char>(1 << (random() % 8));
+			break;
+		case 1: // insert a random byte
+			result.insert(result.begin() + position, static_cast<char>(random() % 256));
+			break;
+		case 2: { // delete a range
+			size_t length = std::min<size_t>(1 + random() % 16, result.size() - std::min(position, result.size()));
+			result.erase(position, length);
+			break;
+		}
+		case 3: { // copy a range somewhere else
+			if (result.empty()) break;
+			size_t from = random() % result.size();
+			std::string piece = result.substr(from, 1 + random() % 64);
+			result.insert(position, piece);
+			break;
+		}
+		case 4: { // swap a number for one near a limit
+			size_t digit = result.find_first_of("0123456789-", position);
+			if (digit == std::string::npos) digit = result.find_first_of("0123456789-");
+			if (digit == std::string::npos) break;
+			size_t end = result.find_first_not_of("0123456789-", digit);
+			result.replace(digit, end == std::string::npos ? std::string::npos : end - digit, numbers[random() % (sizeof(numbers) / sizeof(numbers[0]))]);
+			break;
+		}
+		case 5: // a long run of one character, long rows and many blank lines
+			result.insert(position, 1 + random() % 1024, characters[random() % (sizeof(characters) - 1)]);
+			break;
+		case 6: { // splice in part of another seed
+			const std::string& other = seeds[random() % seeds.size()];
+			if (other.empty()) break;
+			result.insert(position, other.substr(random() % other.size()));
+			break;
+		}
+		default: // overwrite a byte with one the formats care about
+			if (!result.empty()) result[position % result.size()] = characters[random() % (sizeof(characters) - 1)];
+			break;
+		}
+	}
+
+	if (result.size() > this->config.max_input) result.resize(this->config.max_input);
+	return result;
+}
+
+void LoaderFuzzer::saveInput(const std::string& input, const std::string& loader, uint64_t run) const {
+	std::string path = this->config.output_directory + "/fuzz-" + loader + "-" + std::to_string(run) + ".txt";
+	std::ofstream file(path, std::ios::binary);
+	if (!file.is_open()) {
+		std::cerr << "ERROR: Couldn't save input to " << path << std::endl;
+		return;
+	}
+	file.write(input.data(), static_cast<std::streamsize>(input.size()));
+	std::cout << "  saved to " << path << std::endl;
+}
+
+bool LoaderFuzzer::parseArguments(int argc, char* argv[], Config& config) {
+	bool parsed = CommandLine::parseOptions(argc, argv, [&config](const std::string& option, const std::string& value) {
+		if (option == "--runs") config.runs = static_cast<uint64_t>(CommandLine::toInteger(value, 1, INT64_MAX));
+		else if (option == "--seed") config.seed = static_cast<unsigned int>(CommandLine::toInteger(value, 0, UINT32_MAX));
+		else if (option == "--max-input") config.max_input = static_cast<size_t>(CommandLine::toInteger(value, 1, MAX_INPUT));
+		else if (option == "--max-ms") config.max_milliseconds = std::stod(value);
+		else if (option == "--max-mb") config.memory_budget = static_cast<size_t>(CommandLine::toInteger(value, 1, SIZE_MAX >> 21)) * 1024 * 1024;
+		else if (option == "--corpus") config.corpus = value;
+		else if (option == "--output") config.output_directory = value;
+		else return false;
+		return true;
+	});
+	if (!parsed) return false;
+
+	if (config.max_input == 0 || !(config.max_milliseconds > 0.0) || config.memory_budget == 0) {
+		std::cerr << "ERROR: Invalid fuzzing limits" << std::endl;
+		return false;
+	} // exit if no input could pass
+
+	return true;
+}
+
+int LoaderFuzzer::runFromArguments(int argc, char* argv[]) {
+	Config config;
+	if (!LoaderFuzzer::parseArguments(argc, argv, config)) {
+		return 1;
+	}
+
+	LoaderFuzzer fuzzer(config);
+	return fuzzer.run() ? 0 : 1;
+}
+
+#ifdef GOL_LIBFUZZER
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+	static const std::vector<LoaderFuzzer::Loader> loaders = LoaderFuzzer::getLoaders();
+	static const LoaderFuzzer::Config limits;
+
+	std::string input(reinterpret_cast<const char*>(data), size);
+	for (const LoaderFuzzer::Loader& loader : loaders) {
+		std::string problem;
+		if (!LoaderFuzzer::checkInput(loader, input, limits.memory_budget, limits.max_milliseconds, problem)) {
+			std::cerr << "ERROR: " << loader.name << " loader " << problem << std::endl;
+			std::abort(); // libfuzzer saves the input that got here
+		}
+	}
+	return 0;
+} // libfuzzer's entry point, it brings its own main so the game's isn't linked in
+#endif
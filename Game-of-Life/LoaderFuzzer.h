@@ -0,0 +1,53 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <random>
+#include <string>
+#include <vector>
+
+class Universe;
+
+// feeds the pattern loaders generated and mutated input, every input has to load or be rejected within a time and memory limit
+// runs on its own with --fuzz-loaders, or under libfuzzer when built with GOL_LIBFUZZER and -fsanitize=fuzzer,
+// either way it's meant to be built with address and undefined behaviour sanitizers so bad reads crash on the spot
+class LoaderFuzzer {
+public:
+	struct Config {
+		uint64_t runs = 100000; // inputs per loader
+		unsigned int seed = 1;
+		size_t max_input = 4096; // bytes, mutations don't grow inputs past this
+		double max_milliseconds = 100.0; // per input
+		size_t memory_budget = 64 * 1024 * 1024; // handed to the universe, a load mustn't hold more at any point
+		std::string corpus; // directory of extra seed inputs, empty uses the built-in ones only
+		std::string output_directory = "."; // where inputs that broke a limit are written
+	};
+
+	struct Loader {
+		std::string name;
+		std::function<bool(Universe&, std::istream&)> load;
+	};
+
+	LoaderFuzzer(const Config& config);
+
+	bool run(); // returns true if no input broke a limit
+	int getFailureCount() const;
+
+	static std::vector<Loader> getLoaders();
+	static bool checkInput(const Loader& loader, const std::string& input, size_t memory_budget, double max_milliseconds, std::string& problem); // false if the load took too long or held too much memory at its peak, problem says which
+	static bool parseArguments(int argc, char* argv[], Config& config); // --runs, --seed, --max-input, --max-ms, --max-mb, --corpus, --output
+	static int runFromArguments(int argc, char* argv[]); // entry point for --fuzz-loaders, returns the process exit code
+
+	static constexpr int64_t MAX_INPUT = 64 * 1024 * 1024; // bytes, each corpus file is read into a buffer this size
+
+private:
+	// ---- methods ----
+	std::vector<std::string> getSeeds() const; // built-in inputs plus the corpus directory
+	std::string mutate(const std::string& input, const std::vector<std::string>& seeds, std::mt19937& random) const;
+	void saveInput(const std::string& input, const std::string& loader, uint64_t run) const;
+
+	// ---- attributes ----
+	Config config;
+	int failures = 0;
+};
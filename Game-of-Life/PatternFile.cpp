@@ -0,0 +1,312 @@
+#include "PatternFile.h"
+#include <algorithm>
+#include <cctype>
+#include <limits>
+#include <iostream>
+
+PatternFile::Format PatternFile::detectFormat(const std::string& filename, std::istream& input) {
+	std::string line;
+	size_t length = 0;
+	PatternFile::readLine(input, line, 64, length);
+	input.clear();
+	input.seekg(0); // the loader reads the first line again
+
+	if (line.compare(0, 10, "#Life 1.06") == 0) return Format::Life106;
+	if (!line.empty() && (line[0] == '!' || line[0] == '.' || line[0] == 'O')) return Format::Cells;
+	return PatternFile::getFormatOfFilename(filename); // a first line of digits is the dense format's header, unless the name says otherwise
+}
+
+PatternFile::Format PatternFile::getFormatOfFilename(const std::string& filename) {
+	size_t dot = filename.find_last_of('.');
+	if (dot == std::string::npos) return Format::Dense;
+
+	std::string extension = filename.substr(dot + 1);
+	for (char& c : extension) {
+		c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+	}
+
+	if (extension == "cells") return Format::Cells;
+	if (extension == "lif" || extension == "life") return Format::Life106;
+	return Format::Dense;
+}
+
+bool PatternFile::readCells(std::istream& input, SparsePattern& pattern, size_t max_cells) {
+	pattern = SparsePattern();
+	std::streambuf* buffer = input.rdbuf(); // a character at a time, a row is never held in memory
+	int64_t x = 0, y = 0, width = 0, height = 0;
+	bool line_start = true, comment = false;
+
+	for (std::streambuf::int_type c = buffer->sbumpc(); c != std::streambuf::traits_type::eof(); c = buffer->sbumpc()) {
+		if (c == '\r') continue; // files saved on windows
+
+		if (c == '\n') {
+			if (!comment) y++;
+			x = 0;
+			line_start = true;
+			comment = false;
+			continue;
+		}
+
+		if (line_start && c == '!') comment = true;
+		line_start = false;
+		if (comment || c == ' ' || c == '\t') continue;
+
+		if (c != '.' && c != 'O' && c != '*') {
+			std::cout << "ERROR: Unexpected character in .cells row " << y + 1 << ", column " << x + 1 << std::endl;
+			return false;
+		} // some writers use '*' for live cells
+
+		if (x >= std::numeric_limits<int>::max() || y >= std::numeric_limits<int>::max()) {
+			std::cout << "ERROR: .cells pattern is too large" << std::endl;
+			return false;
+		}
+
+		if (c != '.') {
+			if (pattern.cells.size() >= max_cells) {
+				std::cout << "ERROR: .cells pattern has more than " << max_cells << " live cells" << std::endl;
+				return false;
+			}
+			pattern.cells.push_back({static_cast<int>(x), static_cast<int>(y)});
+		}
+		x++;
+		width = std::max(width, x);
+		height = y + 1; // blank lines after the last row aren't part of the pattern
+	}
+
+	pattern.width = static_cast<int>(width);
+	pattern.height = static_cast<int>(height);
+	return true;
+}
+
+bool PatternFile::readLife106(std::istream& input, SparsePattern& pattern, size_t max_cells) {
+	pattern = SparsePattern();
+	std::string line;
+	size_t length = 0;
+
+	if (!PatternFile::readLine(input, line, 64, length) || line.compare(0, 10, "#Life 1.06") != 0) {
+		std::cout << "ERROR: Life 1.06 file doesn't start with #Life 1.06" << std::endl;
+		return false;
+	}
+
+	int64_t min_x = 0, min_y = 0, max_x = -1, max_y = -1;
+	int64_t origin_x = 0, origin_y = 0; // first cell, the others are stored relative to it
+	for (int64_t number = 2; PatternFile::readLine(input, line, 64, length); number++) {
+		if (!line.empty() && line[0] == '#') continue; // comments and descriptions, however long
+
+		if (length > line.size()) {
+			std::cout << "ERROR: Life 1.06 line " << number << " is too long" << std::endl;
+			return false;
+		} // a coordinate pair never needs 64 characters
+
+		size_t position = 0;
+		int64_t x = 0, y = 0;
+		bool blank = line.find_first_not_of(" \t") == std::string::npos;
+		if (blank) continue;
+
+		if (!PatternFile::parseCoordinate(line, position, x) || !PatternFile::parseCoordinate(line, position, y)
+			|| line.find_first_not_of(" \t", position) != std::string::npos) {
+			std::cout << "ERROR: Life 1.06 line " << number << " isn't an x y pair" << std::endl;
+			return false;
+		}
+
+		if (pattern.cells.size() >= max_cells) {
+			std::cout << "ERROR: Life 1.06 pattern has more than " << max_cells << " live cells" << std::endl;
+			return false;
+		}
+
+		if (max_x < min_x) {
+			min_x = max_x = x;
+			min_y = max_y = y;
+		} else {
+			min_x = std::min(min_x, x);
+			max_x = std::max(max_x, x);
+			min_y = std::min(min_y, y);
+			max_y = std::max(max_y, y);
+		}
+
+		if (max_x - min_x >= std::numeric_limits<int>::max() || max_y - min_y >= std::numeric_limits<int>::max()) {
+			std::cout << "ERROR: Life 1.06 pattern is too large" << std::endl;
+			return false;
+		} // the extent has to fit a board, the coordinates themselves can be anywhere
+
+		if (pattern.cells.empty()) {
+			origin_x = x;
+			origin_y = y;
+		}
+		pattern.cells.push_back({static_cast<int>(x - origin_x), static_cast<int>(y - origin_y)}); // the extent fits an int, so offsets from the first cell do too
+	}
+
+	if (pattern.cells.empty()) return true; // an empty pattern is a valid file
+
+	for (std::pair<int, int>& cell : pattern.cells) {
+		cell.first = static_cast<int>(cell.first + origin_x - min_x);
+		cell.second = static_cast<int>(cell.second + origin_y - min_y);
+	} // top left live cell at the origin
+	pattern.width = static_cast<int>(max_x - min_x + 1);
+	pattern.height = static_cast<int>(max_y - min_y + 1);
+	return true;
+}
+
+bool PatternFile::readDenseSize(std::istream& input, int& width, int& height) {
+	if (!(input >> width >> height)) {
+		std::cout << "ERROR: Couldn't read width and height" << std::endl;
+		return false;
+	} // exit if no width or height
+
+	if (width <= 0 || height <= 0) {
+		std::cout << "ERROR: Invalid width and height: " << width << " x " << height << std::endl;
+		return false;
+	} // a board can't be empty or negative
+
+	// skip newline after reading width and height
+	std::string line;
+	size_t length = 0;
+	PatternFile::readLine(input, line, 0, length);
+	return true;
+}
+
+void PatternFile::readDenseRows(std::istream& input, BitGrid& grid, int width, int height) {
+	std::string current_line;
+	size_t line_length = 0;
+	int row = 0; // current row
+	int long_rows = 0, invalid_rows = 0;
+
+	while (row < height && PatternFile::readLine(input, current_line, static_cast<size_t>(width), line_length)) {
+		if (line_length == 0) continue; // skip empty lines
+
+		bool invalid = false;
+		for (int col = 0; col < static_cast<int>(current_line.length()); col++) {
+			grid.setAlive(col, row, current_line[col] == '1');
+			invalid |= current_line[col] != '0' && current_line[col] != '1';
+		} // set cell state
+
+		long_rows += line_length > current_line.length();
+		invalid_rows += invalid;
+		row++; // move to next row
+	}
+
+	bool extra_rows = false;
+	while (!extra_rows && PatternFile::readLine(input, current_line, 1, line_length)) {
+		extra_rows = line_length > 0;
+	} // anything but blank lines after the last row
+
+	if (long_rows > 0 || invalid_rows > 0 || row < height || extra_rows) {
+		std::cout << "WARNING: Loaded a " << width << " x " << height << " board with " << long_rows << " rows cut to the width, "
+			<< invalid_rows << " rows with characters other than 0 and 1, " << (height - row) << " missing rows"
+			<< (extra_rows ? " and rows past the height ignored" : "") << std::endl;
+	} // the board still loads, but say what didn't fit
+}
+
+void PatternFile::writeCells(std::ostream& output, const BitGrid& grid, const std::string& name) {
+	if (!name.empty()) {
+		output << "!Name: " << name << "\n";
+	}
+
+	int words = grid.getWordsPerRow();
+	int last_row = -1;
+	for (int y = grid.getHeight() - 1; y >= 0 && last_row < 0; y--) {
+		const uint64_t* row = grid.row(y);
+		if (std::any_of(row, row + words, [](uint64_t word) { return word != 0; })) last_row = y;
+	} // rows after the last live cell aren't written
+
+	std::string line;
+	for (int y = 0; y <= last_row; y++) {
+		const uint64_t* row = grid.row(y);
+		int last_word = words - 1;
+		while (last_word >= 0 && row[last_word] == 0) last_word--;
+
+		if (last_word < 0) {
+			output << ".\n";
+			continue;
+		} // an empty row still needs a line
+
+		int end = 64 * last_word + 64 - BitGrid::countLeadingZeros(row[last_word]); // one past the last live cell
+		line.assign(static_cast<size_t>(end), '.');
+		for (int k = 0; k <= last_word; k++) {
+			for (uint64_t word = row[k]; word != 0; word &= word - 1) {
+				line[64 * k + BitGrid::countTrailingZeros(word)] = 'O';
+			}
+		}
+		output << line << "\n";
+	}
+}
+
+uint64_t PatternFile::getCellsLength(const BitGrid& grid, const std::string& name) {
+	uint64_t length = name.empty() ? 0 : name.size() + 8; // "!Name: " and the newline
+	uint64_t trailing = 0; // empty rows after the last live cell so far, they're only written if another live row follows
+
+	int words = grid.getWordsPerRow();
+	for (int y = 0; y < grid.getHeight(); y++) {
+		const uint64_t* row = grid.row(y);
+		int last_word = words - 1;
+		while (last_word >= 0 && row[last_word] == 0) last_word--;
+
+		if (last_word < 0) {
+			trailing += 2; // ".\n"
+			continue;
+		}
+
+		length += trailing + 64 * last_word + 64 - BitGrid::countLeadingZeros(row[last_word]) + 1; // up to the last live cell, then the newline
+		trailing = 0;
+	}
+	return length;
+}
+
+void PatternFile::writeLife106(std::ostream& output, const BitGrid& grid) {
+	output << "#Life 1.06\n";
+
+	int words = grid.getWordsPerRow();
+	for (int y = 0; y < grid.getHeight(); y++) {
+		const uint64_t* row = grid.row(y);
+		for (int k = 0; k < words; k++) {
+			for (uint64_t word = row[k]; word != 0; word &= word - 1) {
+				output << 64 * k + BitGrid::countTrailingZeros(word) << " " << y << "\n";
+			} // one bit at a time, lowest first
+		}
+	}
+}
+
+const char* PatternFile::getFormatName(Format format) {
+	switch (format) {
+	case Format::Dense: return "dense";
+	case Format::Cells: return ".cells";
+	case Format::Life106: return "Life 1.06";
+	}
+	return "unknown";
+}
+
+bool PatternFile::readLine(std::istream& input, std::string& line, size_t max_length, size_t& length) {
+	line.clear();
+	length = 0;
+
+	std::streambuf* buffer = input.rdbuf(); // a character at a time without the stream's checks
+	std::streambuf::int_type c = buffer->sbumpc();
+	if (c == std::streambuf::traits_type::eof()) return false;
+
+	for (; c != std::streambuf::traits_type::eof() && c != '\n'; c = buffer->sbumpc()) {
+		if (c == '\r') continue; // files saved on windows
+		if (length < max_length) line.push_back(static_cast<char>(c));
+		length++;
+	}
+	return true;
+}
+
+bool PatternFile::parseCoordinate(const std::string& text, size_t& position, int64_t& value) {
+	while (position < text.size() && (text[position] == ' ' || text[position] == '\t')) position++;
+
+	bool negative = false;
+	if (position < text.size() && (text[position] == '-' || text[position] == '+')) {
+		negative = text[position] == '-';
+		position++;
+	}
+
+	size_t digits = 0;
+	value = 0;
+	for (; position < text.size() && std::isdigit(static_cast<unsigned char>(text[position])); position++, digits++) {
+		if (value > (std::numeric_limits<int64_t>::max() - 9) / 10) return false; // far past any board, and it mustn't overflow
+		value = value * 10 + (text[position] - '0');
+	}
+
+	if (negative) value = -value;
+	return digits > 0;
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "BitGrid.h"
+
+// live cells of a pattern without a board behind them, so a few cells far apart cost a few cells of memory
+struct SparsePattern {
+	int width = 0; // extent of the cells, the board they go on can be larger
+	int height = 0;
+	std::vector<std::pair<int, int>> cells; // x and y, may repeat
+};
+
+// pattern file formats, the project's own dense one and two common ones
+// .cells (plaintext): '!' comment lines, then a row per line with '.' dead and 'O' alive, rows may stop at their last live cell
+// Life 1.06: a "#Life 1.06" line, then one "x y" pair per live cell, coordinates may be negative
+// readers build a sparse pattern; writers scan every word of the board, O(area / 64), but only visit the bits of words that have live cells
+class PatternFile {
+public:
+	enum class Format {
+		Dense, // width and height, then a row of 0s and 1s per line
+		Cells,
+		Life106
+	};
+
+	static Format detectFormat(const std::string& filename, std::istream& input); // by the first line, then the extension, input is rewound
+	static Format getFormatOfFilename(const std::string& filename); // Dense for anything not .cells, .lif or .life
+	static bool readCells(std::istream& input, SparsePattern& pattern, size_t max_cells); // false with an error printed if the input is malformed or has more than max_cells live cells
+	static bool readLife106(std::istream& input, SparsePattern& pattern, size_t max_cells);
+	static bool readDenseSize(std::istream& input, int& width, int& height); // the dense format's header, false with an error printed unless both are positive
+	static void readDenseRows(std::istream& input, BitGrid& grid, int width, int height); // rows after the header into a dead grid at least width x height, warns about rows that don't fit
+	static void writeCells(std::ostream& output, const BitGrid& grid, const std::string& name);
+	static uint64_t getCellsLength(const BitGrid& grid, const std::string& name); // bytes writeCells would write, without building the text
+	static void writeLife106(std::ostream& output, const BitGrid& grid);
+	static const char* getFormatName(Format format);
+	static bool readLine(std::istream& input, std::string& line, size_t max_length, size_t& length); // keeps at most max_length characters however long the line is, length counts them all, false at the end of input
+
+private:
+	static bool parseCoordinate(const std::string& text, size_t& position, int64_t& value); // optionally signed decimal, skips leading blanks
+};
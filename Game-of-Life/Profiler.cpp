@@ -0,0 +1,257 @@
+#include "Profiler.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+std::atomic<bool> Profiler::enabled{false};
+std::atomic<uint32_t> Profiler::next_thread{1};
+
+Profiler::ScopedTimer::ScopedTimer(const char* name) : name(name), active(Profiler::isEnabled()) {
+	if (this->active) {
+		this->start = Clock::now();
+	}
+}
+
+Profiler::ScopedTimer::~ScopedTimer() {
+	if (this->active) {
+		Profiler::instance().record(this->name, this->start, Clock::now());
+	}
+}
+
+Profiler::Profiler() {
+	this->origin = Clock::now();
+}
+
+Profiler& Profiler::instance() {
+	static Profiler profiler;
+	return profiler;
+}
+
+bool Profiler::isEnabled() {
+	return Profiler::enabled.load(std::memory_order_relaxed);
+}
+
+#pragma region Control
+void Profiler::setEnabled(bool enabled) {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	if (enabled && !Profiler::enabled.load()) {
+		this->series.clear();
+	} // start a fresh summary
+	this->summary_enabled = enabled;
+	Profiler::enabled.store(enabled || this->tracing.load());
+}
+
+void Profiler::startTrace() {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->events.clear();
+	this->dropped_events = 0;
+	this->tracing.store(true);
+	Profiler::enabled.store(true);
+}
+
+bool Profiler::stopTrace(const std::string& filename) {
+	std::vector<TraceEvent> recorded;
+	std::map<uint32_t, std::string> names;
+	uint64_t dropped = 0;
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		if (!this->tracing.load()) return false; // nothing recorded
+
+		this->tracing.store(false);
+		Profiler::enabled.store(this->summary_enabled);
+		recorded.swap(this->events);
+		names = this->thread_names;
+		dropped = this->dropped_events;
+	} // write outside the lock so the hot paths aren't held up
+
+	std::ofstream file(filename);
+	if (!file.is_open()) {
+		std::cerr << "ERROR: Couldn't write trace to " << filename << std::endl;
+		return false;
+	} // exit if couldn't open file
+
+	file << std::fixed << std::setprecision(3);
+	file << "{\"traceEvents\":[\n";
+	bool first = true;
+	for (auto& name : names) {
+		file << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << name.first << ",\"args\":{\"name\":";
+		writeEscaped(file, name.second);
+		file << "}}";
+		first = false;
+	} // thread labels
+
+	for (auto& event : recorded) {
+		file << (first ? "" : ",\n") << "{\"name\":";
+		writeEscaped(file, event.name);
+		file << ",\"ph\":\"" << event.phase << "\",\"pid\":1,\"tid\":" << event.thread << ",\"ts\":" << event.timestamp_us;
+		if (event.phase == 'X') {
+			file << ",\"dur\":" << event.value << "}";
+		} else {
+			file << ",\"args\":{\"value\":" << event.value << "}}";
+		}
+		first = false;
+	}
+	file << "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped_events\":" << dropped << "}}\n";
+
+	std::cout << "Wrote " << recorded.size() << " trace events to " << filename << std::endl;
+	return true;
+}
+
+bool Profiler::isTracing() const {
+	return this->tracing.load();
+}
+
+void Profiler::setThreadName(const char* name) {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->thread_names[currentThread()] = name;
+}
+#pragma endregion
+
+#pragma region Recording
+void Profiler::record(const char* name, Clock::time_point start, Clock::time_point end) {
+	double duration_ms = std::chrono::duration<double, std::milli>(end - start).count();
+
+	std::lock_guard<std::mutex> lock(this->mutex);
+	auto it = this->series.find(name);
+	if (it == this->series.end()) {
+		it = this->series.emplace(name, Series{}).first;
+		it->second.samples.reserve(WINDOW);
+	}
+
+	Series& series = it->second;
+	if (series.samples.size() < WINDOW) {
+		series.samples.push_back(duration_ms);
+	} else {
+		series.samples[series.next] = duration_ms;
+	}
+	series.next = (series.next + 1) % WINDOW;
+	series.count++;
+
+	if (this->tracing.load()) {
+		if (this->events.size() < MAX_TRACE_EVENTS) {
+			this->events.push_back({name, 'X', currentThread(), this->toMicroseconds(start), duration_ms * 1000.0});
+		} else {
+			this->dropped_events++;
+		}
+	}
+}
+
+void Profiler::counter(const char* name, double value) {
+	if (!Profiler::isEnabled()) return;
+
+	std::lock_guard<std::mutex> lock(this->mutex);
+	auto it = this->counters.find(name);
+	if (it == this->counters.end()) {
+		this->counters.emplace(name, value);
+	} else {
+		it->second = value;
+	}
+
+	if (this->tracing.load()) {
+		if (this->events.size() < MAX_TRACE_EVENTS) {
+			this->events.push_back({name, 'C', currentThread(), this->toMicroseconds(Clock::now()), value});
+		} else {
+			this->dropped_events++;
+		}
+	}
+}
+
+std::unique_lock<std::mutex> Profiler::lockTimed(std::mutex& mutex, const char* name) {
+	if (!Profiler::isEnabled()) {
+		return std::unique_lock<std::mutex>(mutex);
+	} // plain lock while profiling is off
+
+	std::unique_lock<std::mutex> lock(mutex, std::try_to_lock);
+	if (lock.owns_lock()) return lock; // uncontended, don't record a zero length wait
+
+	Clock::time_point start = Clock::now();
+	lock.lock();
+	this->record(name, start, Clock::now());
+	return lock;
+}
+#pragma endregion
+
+#pragma region Summary
+Profiler::Summary Profiler::getSummary(const char* name) const {
+	std::vector<double> samples;
+	Summary summary;
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		auto it = this->series.find(name);
+		if (it == this->series.end()) return summary; // nothing recorded
+
+		samples = it->second.samples;
+		summary.count = it->second.count;
+	}
+
+	if (samples.empty()) return summary;
+
+	std::sort(samples.begin(), samples.end());
+	auto percentile = [&samples](double p) {
+		return samples[std::min(samples.size() - 1, static_cast<size_t>(p * samples.size()))];
+	};
+
+	double total = 0.0;
+	for (double sample : samples) {
+		total += sample;
+	}
+
+	summary.mean_ms = total / samples.size();
+	summary.p50_ms = percentile(0.50);
+	summary.p95_ms = percentile(0.95);
+	summary.p99_ms = percentile(0.99);
+	summary.max_ms = samples.back();
+	return summary;
+}
+
+double Profiler::getCounter(const char* name) const {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	auto it = this->counters.find(name);
+	return it == this->counters.end() ? 0.0 : it->second;
+}
+
+void Profiler::writeSummary(std::ostream& out) const {
+	std::vector<std::string> names;
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		for (auto& item : this->series) {
+			names.push_back(item.first);
+		}
+	}
+
+	std::ios_base::fmtflags flags = out.flags();
+	std::streamsize precision = out.precision();
+	out << std::fixed << std::setprecision(3);
+	out << std::left << std::setw(28) << "scope" << std::right << std::setw(10) << "count" << std::setw(10) << "mean"
+		<< std::setw(10) << "p50" << std::setw(10) << "p95" << std::setw(10) << "p99" << std::setw(10) << "max" << " (ms)" << '\n';
+
+	for (auto& name : names) {
+		Summary summary = this->getSummary(name.c_str());
+		out << std::left << std::setw(28) << name << std::right << std::setw(10) << summary.count << std::setw(10) << summary.mean_ms
+			<< std::setw(10) << summary.p50_ms << std::setw(10) << summary.p95_ms << std::setw(10) << summary.p99_ms << std::setw(10) << summary.max_ms << '\n';
+	}
+
+	out.flags(flags);
+	out.precision(precision);
+	out.flush();
+}
+#pragma endregion
+
+double Profiler::toMicroseconds(Clock::time_point time) const {
+	return std::chrono::duration<double, std::micro>(time - this->origin).count();
+}
+
+uint32_t Profiler::currentThread() {
+	static thread_local uint32_t id = Profiler::next_thread.fetch_add(1);
+	return id;
+}
+
+void Profiler::writeEscaped(std::ostream& out, const std::string& text) {
+	out << '"';
+	for (char c : text) {
+		if (c == '"' || c == '\\') out << '\\';
+		out << c;
+	}
+	out << '"';
+}
@@ -0,0 +1,114 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// time a scope under a name, does nothing but check a flag while profiling is off
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) Profiler::ScopedTimer PROFILE_CONCAT(profile_scope_, __LINE__)(name)
+
+// scoped timers and counters for the hot paths
+// keeps a rolling summary per name while enabled and records chrome trace events while tracing
+class Profiler {
+public:
+	using Clock = std::chrono::steady_clock;
+
+	struct Summary {
+		uint64_t count = 0; // samples since profiling was enabled
+		double mean_ms = 0.0; // the rest are over the rolling window
+		double p50_ms = 0.0;
+		double p95_ms = 0.0;
+		double p99_ms = 0.0;
+		double max_ms = 0.0;
+	};
+
+	class ScopedTimer {
+	public:
+		explicit ScopedTimer(const char* name);
+		~ScopedTimer();
+		ScopedTimer(const ScopedTimer&) = delete;
+		ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+	private:
+		const char* name;
+		Clock::time_point start;
+		bool active;
+	};
+
+	static Profiler& instance();
+	static bool isEnabled(); // cheap enough to call on every scope
+
+#pragma region Control
+public:
+	// ---- methods ----
+	void setEnabled(bool enabled); // collect summaries, turned on by tracing too
+	void startTrace();
+	bool stopTrace(const std::string& filename); // write the recorded events as trace event json
+	bool isTracing() const;
+	void setThreadName(const char* name); // label the calling thread in traces
+#pragma endregion
+
+#pragma region Recording
+public:
+	// ---- methods ----
+	void record(const char* name, Clock::time_point start, Clock::time_point end);
+	void counter(const char* name, double value);
+	std::unique_lock<std::mutex> lockTimed(std::mutex& mutex, const char* name); // lock and record how long the wait took
+#pragma endregion
+
+#pragma region Summary
+public:
+	// ---- methods ----
+	Summary getSummary(const char* name) const;
+	double getCounter(const char* name) const; // latest value
+	void writeSummary(std::ostream& out) const;
+#pragma endregion
+
+private:
+	Profiler();
+	Profiler(const Profiler&) = delete;
+	Profiler& operator=(const Profiler&) = delete;
+
+	struct Series {
+		std::vector<double> samples; // ring of the latest durations in ms
+		size_t next = 0;
+		uint64_t count = 0;
+	};
+
+	struct TraceEvent {
+		const char* name;
+		char phase; // 'X' for a complete scope, 'C' for a counter
+		uint32_t thread;
+		double timestamp_us;
+		double value; // duration in us for scopes, the value for counters
+	};
+
+	// ---- methods ----
+	double toMicroseconds(Clock::time_point time) const;
+	static uint32_t currentThread();
+	static void writeEscaped(std::ostream& out, const std::string& text);
+
+	// ---- attributes ----
+	static std::atomic<bool> enabled;
+	std::atomic<bool> tracing{false};
+	bool summary_enabled = false; // what setEnabled asked for, restored when tracing stops
+	Clock::time_point origin;
+
+	mutable std::mutex mutex;
+	std::map<std::string, Series, std::less<>> series;
+	std::map<std::string, double, std::less<>> counters;
+	std::vector<TraceEvent> events;
+	std::map<uint32_t, std::string> thread_names;
+	uint64_t dropped_events = 0;
+
+	static std::atomic<uint32_t> next_thread;
+	static constexpr size_t WINDOW = 256; // samples kept per name for percentiles
+	static constexpr size_t MAX_TRACE_EVENTS = 1 << 20; // ~40MB, later events are dropped
+};
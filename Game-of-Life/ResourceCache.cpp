@@ -0,0 +1,151 @@
+#include "ResourceCache.h"
+#include "Profiler.h"
+#include <SDL_image.h>
+#include <algorithm>
+#include <vector>
+#include <iostream>
+
+UI::ResourceCache& UI::ResourceCache::instance() {
+	static ResourceCache cache;
+	return cache;
+}
+
+TTF_Font* UI::ResourceCache::getFont(const std::string& path, int size) {
+	std::string key = path + "#" + std::to_string(size);
+
+	auto it = this->fonts.find(key);
+	if (it != this->fonts.end()) {
+		return it->second;
+	} // return font if already loaded
+
+	TTF_Font* font = TTF_OpenFont(path.c_str(), size);
+	if (!font) {
+		std::cerr << "ERROR: Couldn't load font " << path << " errormsg: " << TTF_GetError() << std::endl;
+	} // failures are cached too so a missing font isn't retried every frame
+
+	this->fonts[key] = font;
+	return font;
+}
+
+UI::TextTexture UI::ResourceCache::getText(SDL_Renderer* renderer, TTF_Font* font, const std::string& text, SDL_Color color, TextMode mode) {
+	if (!renderer || !font || text.empty()) return TextTexture{}; // nothing to render
+
+	std::string key = std::to_string(reinterpret_cast<uintptr_t>(renderer)) + "|"
+		+ std::to_string(reinterpret_cast<uintptr_t>(font)) + "|"
+		+ std::to_string(static_cast<int>(mode)) + "|"
+		+ std::to_string((color.r << 24) | (color.g << 16) | (color.b << 8) | color.a) + "|"
+		+ text;
+
+	auto it = this->texts.find(key);
+	if (it != this->texts.end()) {
+		it->second.last_used = ++this->use_counter;
+		return it->second.text;
+	} // return cached texture
+
+	PROFILE_SCOPE("text render"); // only misses reach the rasterizer
+	SDL_Surface* surface = (mode == TextMode::Solid)
+		? TTF_RenderText_Solid(font, text.c_str(), color)
+		: TTF_RenderText_Blended(font, text.c_str(), color);
+	if (!surface) return TextTexture{}; // exit if text couldn't be rendered
+
+	TextTexture result;
+	result.texture = SDL_CreateTextureFromSurface(renderer, surface);
+	result.width = surface->w;
+	result.height = surface->h;
+	SDL_FreeSurface(surface);
+
+	if (!result.texture) return TextTexture{}; // exit if texture couldn't be created
+
+	if (this->texts.size() >= MAX_CACHED_TEXTS) {
+		this->evictText();
+	} // keep cache bounded for frequently changing text (e.g. textbox input)
+
+	this->texts[key] = CachedText{result, renderer, ++this->use_counter};
+	return result;
+}
+
+SDL_Texture* UI::ResourceCache::getIcon(SDL_Renderer* renderer, const std::string& path) {
+	if (!renderer) return nullptr;
+
+	std::string key = std::to_string(reinterpret_cast<uintptr_t>(renderer)) + "|" + path;
+
+	auto it = this->icons.find(key);
+	if (it != this->icons.end()) {
+		return it->second.texture;
+	} // return icon if already loaded for this renderer
+
+	SDL_Texture* texture = nullptr;
+	SDL_Surface* surface = IMG_Load(path.c_str());
+
+	if (!surface) {
+		std::cerr << "ERROR: Couldn't load icon " << path << " errormsg: " << IMG_GetError() << std::endl;
+	} else {
+		texture = SDL_CreateTextureFromSurface(renderer, surface);
+		if (!texture) {
+			std::cerr << "ERROR: Couldn't create texture, errormsg: " << SDL_GetError() << std::endl;
+		}
+		SDL_FreeSurface(surface);
+	} // failures are cached too so a missing icon isn't reloaded every frame
+
+	this->icons[key] = CachedIcon{texture, renderer};
+	return texture;
+}
+
+void UI::ResourceCache::releaseRenderer(SDL_Renderer* renderer) {
+	for (auto it = this->texts.begin(); it != this->texts.end();) {
+		if (it->second.renderer == renderer) {
+			SDL_DestroyTexture(it->second.text.texture);
+			it = this->texts.erase(it);
+		} else {
+			++it;
+		}
+	} // release text textures
+
+	for (auto it = this->icons.begin(); it != this->icons.end();) {
+		if (it->second.renderer == renderer) {
+			if (it->second.texture) SDL_DestroyTexture(it->second.texture);
+			it = this->icons.erase(it);
+		} else {
+			++it;
+		}
+	} // release icon textures
+}
+
+void UI::ResourceCache::clear() {
+	for (auto& [key, cached] : this->texts) {
+		SDL_DestroyTexture(cached.text.texture);
+	}
+	this->texts.clear();
+
+	for (auto& [key, cached] : this->icons) {
+		if (cached.texture) SDL_DestroyTexture(cached.texture);
+	}
+	this->icons.clear();
+
+	for (auto& [key, font] : this->fonts) {
+		if (font) TTF_CloseFont(font);
+	}
+	this->fonts.clear();
+}
+
+void UI::ResourceCache::evictText() {
+	// find the median last use and drop everything older than it
+	std::vector<uint64_t> stamps;
+	stamps.reserve(this->texts.size());
+	for (auto& [key, cached] : this->texts) {
+		stamps.push_back(cached.last_used);
+	}
+
+	auto middle = stamps.begin() + stamps.size() / 2;
+	std::nth_element(stamps.begin(), middle, stamps.end());
+	uint64_t threshold = *middle;
+
+	for (auto it = this->texts.begin(); it != this->texts.end();) {
+		if (it->second.last_used < threshold) {
+			SDL_DestroyTexture(it->second.text.texture);
+			it = this->texts.erase(it);
+		} else {
+			++it;
+		}
+	}
+}
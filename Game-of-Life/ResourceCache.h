@@ -0,0 +1,57 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <SDL.h>
+#include <SDL_ttf.h>
+
+namespace UI {
+	// pre-rendered text texture and its size in pixels
+	struct TextTexture {
+		SDL_Texture* texture = nullptr;
+		int width = 0;
+		int height = 0;
+	};
+
+	enum class TextMode {
+		Solid,
+		Blended
+	};
+
+	// loads fonts and icons once and keeps pre-rendered text textures so nothing touches the disk in the render loop
+	class ResourceCache {
+	public:
+		static ResourceCache& instance();
+
+		TTF_Font* getFont(const std::string& path, int size);
+		TextTexture getText(SDL_Renderer* renderer, TTF_Font* font, const std::string& text, SDL_Color color, TextMode mode);
+		SDL_Texture* getIcon(SDL_Renderer* renderer, const std::string& path);
+		void releaseRenderer(SDL_Renderer* renderer); // destroy every texture owned by a renderer before it is destroyed
+		void clear(); // free everything, must run before TTF_Quit
+
+	private:
+		ResourceCache() = default;
+		ResourceCache(const ResourceCache&) = delete;
+		ResourceCache& operator=(const ResourceCache&) = delete;
+
+		struct CachedText {
+			TextTexture text;
+			SDL_Renderer* renderer;
+			uint64_t last_used;
+		};
+
+		struct CachedIcon {
+			SDL_Texture* texture;
+			SDL_Renderer* renderer;
+		};
+
+		void evictText();
+
+		std::unordered_map<std::string, TTF_Font*> fonts; // keyed by path and size
+		std::unordered_map<std::string, CachedText> texts; // keyed by renderer, font, mode, color and string
+		std::unordered_map<std::string, CachedIcon> icons; // keyed by renderer and path
+		uint64_t use_counter = 0;
+
+		static constexpr size_t MAX_CACHED_TEXTS = 512;
+	};
+}
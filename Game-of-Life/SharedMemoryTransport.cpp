@@ -0,0 +1,124 @@
+#include "SharedMemoryTransport.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <string>
+#include <thread>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+#include <iostream>
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "ring counters are shared between processes, they can't hide a lock");
+
+uint64_t* SharedMemoryTransport::Ring::getSlot(uint64_t index) {
+	uint64_t* slots = reinterpret_cast<uint64_t*>(this + 1);
+	return slots + (index % this->capacity) * this->message_words;
+}
+
+size_t SharedMemoryTransport::Ring::getBytes(size_t message_words, size_t capacity) {
+	size_t bytes = sizeof(Ring) + message_words * capacity * sizeof(uint64_t);
+	return (bytes + 63) / 64 * 64;
+}
+
+SharedMemoryTransport::Ring* SharedMemoryTransport::Ring::create(void* memory, size_t message_words, size_t capacity) {
+	Ring* ring = new (memory) Ring;
+	ring->head.store(0);
+	ring->tail.store(0);
+	ring->message_words = message_words;
+	ring->capacity = std::max<size_t>(capacity, 1);
+	return ring;
+}
+
+SharedMemoryTransport::SharedMemoryTransport(Ring* const incoming[4], Ring* const outgoing[4], const std::atomic<int>* abort) {
+	for (int i = 0; i < 4; i++) {
+		this->incoming[i] = incoming[i];
+		this->outgoing[i] = outgoing[i];
+	}
+	this->abort = abort;
+}
+
+bool SharedMemoryTransport::hasNeighbour(Direction direction) const {
+	return this->outgoing[direction] != nullptr;
+}
+
+bool SharedMemoryTransport::send(Direction direction, const uint64_t* words, size_t count) {
+	Ring* ring = this->outgoing[direction];
+	if (!ring || count > ring->message_words) return false;
+
+	uint64_t head = ring->head.load(std::memory_order_relaxed);
+	if (head >= ring->capacity && !this->wait(ring->tail, head - ring->capacity + 1)) {
+		return false;
+	} // wait for the reader to free a slot
+
+	std::memcpy(ring->getSlot(head), words, count * sizeof(uint64_t));
+	ring->head.store(head + 1, std::memory_order_release); // publishes the message
+	return true;
+}
+
+bool SharedMemoryTransport::receive(Direction direction, uint64_t* words, size_t count) {
+	Ring* ring = this->incoming[direction];
+	if (!ring || count > ring->message_words) return false;
+
+	uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+	if (!this->wait(ring->head, tail + 1)) {
+		return false;
+	} // wait for the writer's next message
+
+	std::memcpy(words, ring->getSlot(tail), count * sizeof(uint64_t));
+	ring->tail.store(tail + 1, std::memory_order_release); // hands the slot back
+	return true;
+}
+
+void* SharedMemoryTransport::mapSegment(size_t bytes) {
+#if defined(__unix__) || defined(__APPLE__)
+	std::string name = "/gol-halo-" + std::to_string(getpid());
+	int file = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+	if (file < 0) {
+		std::cerr << "ERROR: Couldn't create shared memory " << name << std::endl;
+		return nullptr;
+	}
+	shm_unlink(name.c_str()); // forked workers inherit the mapping, so the name isn't needed past this point
+
+	void* segment = MAP_FAILED;
+	if (ftruncate(file, static_cast<off_t>(bytes)) == 0) {
+		segment = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+	} // a fresh shared memory object reads as zeros
+	close(file);
+
+	if (segment == MAP_FAILED) {
+		std::cerr << "ERROR: Couldn't map " << (bytes >> 20) << " MB of shared memory" << std::endl;
+		return nullptr;
+	}
+	return segment;
+#else
+	(void)bytes;
+	std::cerr << "ERROR: Shared memory between processes isn't supported on this platform" << std::endl;
+	return nullptr;
+#endif
+}
+
+void SharedMemoryTransport::unmapSegment(void* segment, size_t bytes) {
+#if defined(__unix__) || defined(__APPLE__)
+	if (segment) munmap(segment, bytes);
+#else
+	(void)segment;
+	(void)bytes;
+#endif
+}
+
+bool SharedMemoryTransport::wait(const std::atomic<uint64_t>& counter, uint64_t target) const {
+	for (int attempt = 0; counter.load(std::memory_order_acquire) < target; attempt++) {
+		if (this->abort && this->abort->load(std::memory_order_relaxed)) {
+			return false;
+		}
+
+		if (attempt < 64) continue; // the neighbour is usually a few rows from done
+		if (attempt < 1024) std::this_thread::yield();
+		else std::this_thread::sleep_for(std::chrono::microseconds(50)); // more workers than cpus, let the slow one run
+	}
+	return true;
+}
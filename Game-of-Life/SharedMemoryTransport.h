@@ -0,0 +1,42 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "HaloTransport.h"
+
+// halo transport between processes on one machine, through ring buffers in a posix shared memory segment
+// every ordered pair of neighbours has its own ring, so each ring has exactly one writer and one reader and needs no lock
+// a worker can run ahead of a neighbour by as many generations as the ring holds before sending blocks
+class SharedMemoryTransport : public HaloTransport {
+public:
+	// fixed size messages, lives inside the shared segment and is followed by its slots
+	struct Ring {
+		alignas(64) std::atomic<uint64_t> head; // messages written, only the writer stores it
+		alignas(64) std::atomic<uint64_t> tail; // messages read, only the reader stores it
+		alignas(64) uint64_t message_words;
+		uint64_t capacity;
+
+		uint64_t* getSlot(uint64_t index);
+
+		static size_t getBytes(size_t message_words, size_t capacity); // header and slots, a multiple of the cache line
+		static Ring* create(void* memory, size_t message_words, size_t capacity); // memory must be cache line aligned
+	};
+
+	SharedMemoryTransport(Ring* const incoming[4], Ring* const outgoing[4], const std::atomic<int>* abort); // indexed by direction, nullptr where there's no neighbour
+
+	bool hasNeighbour(Direction direction) const override;
+	bool send(Direction direction, const uint64_t* words, size_t count) override;
+	bool receive(Direction direction, uint64_t* words, size_t count) override;
+
+	static void* mapSegment(size_t bytes); // zeroed segment shared with processes forked after this, nullptr on failure
+	static void unmapSegment(void* segment, size_t bytes);
+
+private:
+	// ---- methods ----
+	bool wait(const std::atomic<uint64_t>& counter, uint64_t target) const; // spin, then yield, then sleep until the counter reaches target, false if aborted
+
+	// ---- attributes ----
+	Ring* incoming[4];
+	Ring* outgoing[4];
+	const std::atomic<int>* abort; // set by the coordinator when a worker failed, so the others stop waiting for it
+};
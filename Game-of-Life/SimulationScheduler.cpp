@@ -0,0 +1,180 @@
+#include "SimulationScheduler.h"
+#include "Profiler.h"
+#include <algorithm>
+
+SimulationScheduler::SimulationScheduler(Universe* universe, double target_rate) : universe(universe), target_rate(std::max(target_rate, 0.01)) {}
+
+SimulationScheduler::~SimulationScheduler() {
+	this->stop();
+	this->join();
+}
+
+#pragma region Control
+void SimulationScheduler::start() {
+	if (this->running.load()) return; // already running
+
+	this->join(); // make sure a previously stopped thread has finished
+
+	this->generation_count.store(0);
+	this->dropped_count.store(0);
+	this->achieved_rate.store(0.0);
+	this->running.store(true);
+	this->thread = std::thread(&SimulationScheduler::run, this);
+}
+
+void SimulationScheduler::stop() {
+	{
+		std::lock_guard<std::mutex> lock(this->wait_mutex);
+		this->running.store(false);
+	} // set under the wait mutex so a waiting thread can't miss the notification
+	this->wait_cv.notify_all();
+}
+
+void SimulationScheduler::join() {
+	if (this->thread.joinable() && this->thread.get_id() != std::this_thread::get_id()) {
+		this->thread.join();
+	}
+}
+
+bool SimulationScheduler::isRunning() const {
+	return this->running.load();
+}
+#pragma endregion
+
+#pragma region Configuration
+void SimulationScheduler::setTargetRate(double generations_per_second) {
+	this->target_rate.store(std::max(generations_per_second, 0.01));
+}
+
+double SimulationScheduler::getTargetRate() const {
+	return this->target_rate.load();
+}
+
+void SimulationScheduler::setUnlimited(bool unlimited) {
+	this->unlimited.store(unlimited);
+}
+
+bool SimulationScheduler::isUnlimited() const {
+	return this->unlimited.load();
+}
+
+void SimulationScheduler::setOverrunPolicy(OverrunPolicy policy) {
+	this->overrun_policy.store(policy);
+}
+
+SimulationScheduler::OverrunPolicy SimulationScheduler::getOverrunPolicy() const {
+	return this->overrun_policy.load();
+}
+
+void SimulationScheduler::setStopOnCycle(bool stop) {
+	this->stop_on_cycle.store(stop);
+}
+#pragma endregion
+
+#pragma region Statistics
+double SimulationScheduler::getAchievedRate() const {
+	return this->achieved_rate.load();
+}
+
+uint64_t SimulationScheduler::getGenerationCount() const {
+	return this->generation_count.load();
+}
+
+uint64_t SimulationScheduler::getDroppedCount() const {
+	return this->dropped_count.load();
+}
+#pragma endregion
+
+void SimulationScheduler::run() {
+	Profiler::instance().setThreadName("simulation");
+
+	auto toPeriod = [](double rate) {
+		return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / rate));
+	}; // convert generations per second to a step period
+
+	double current_rate = this->target_rate.load();
+	Clock::duration period = toPeriod(current_rate);
+
+	Clock::time_point now = Clock::now();
+	Clock::time_point next_deadline = now + period; // start time of the next generation
+	this->rate_window_start = now;
+	this->rate_window_generations = 0;
+
+	Clock::time_point last_publish = now - PUBLISH_INTERVAL;
+
+	while (this->running.load()) {
+		// in unlimited mode only hand generations to the renderer at display rate, the copy would otherwise cost as much as the step
+		bool publish = !this->unlimited.load() || Clock::now() - last_publish >= PUBLISH_INTERVAL;
+		this->universe->nextGeneration(publish);
+		if (publish) {
+			last_publish = Clock::now();
+		}
+		this->generation_count.fetch_add(1);
+		this->rate_window_generations++;
+
+		now = Clock::now();
+		this->updateAchievedRate(now);
+
+		if (this->stop_on_cycle.load() && this->universe->getCycle().found) {
+			this->running.store(false);
+			break;
+		} // nothing new will happen, stop stepping
+
+		if (this->unlimited.load()) {
+			next_deadline = now + period;
+			continue;
+		} // never sleep in unlimited mode
+
+		double rate = this->target_rate.load();
+		if (rate != current_rate) {
+			current_rate = rate;
+			period = toPeriod(current_rate);
+			next_deadline = now + period;
+		} // restart the schedule if the target rate changed
+
+		if (now < next_deadline) {
+			if (!this->waitUntil(next_deadline)) break;
+		} else {
+			int64_t missed = (now - next_deadline) / period; // whole periods the last step overran by
+
+			if (this->overrun_policy.load() == OverrunPolicy::CatchUp) {
+				if (missed >= MAX_CATCH_UP) {
+					next_deadline = now;
+				} // too far behind, resync instead of bursting
+			} else if (missed > 0) {
+				this->dropped_count.fetch_add(missed);
+				next_deadline += missed * period;
+			} // skip the missed generations
+		} // overrun, run the next generation immediately
+
+		next_deadline += period;
+	}
+
+	this->universe->publish(); // make sure the renderer ends on the last generation
+	this->achieved_rate.store(0.0);
+}
+
+bool SimulationScheduler::waitUntil(Clock::time_point deadline) {
+	{
+		std::unique_lock<std::mutex> lock(this->wait_mutex);
+		this->wait_cv.wait_until(lock, deadline - SPIN_MARGIN, [this]() {
+			return !this->running.load();
+		});
+	} // coarse sleep, wakes early if stopped
+
+	while (this->running.load() && Clock::now() < deadline) {
+		std::this_thread::yield();
+	} // fine wait for the remaining margin
+
+	return this->running.load();
+}
+
+void SimulationScheduler::updateAchievedRate(Clock::time_point now) {
+	auto elapsed = now - this->rate_window_start;
+	if (elapsed < RATE_WINDOW) return; // wait until the window is full
+
+	double seconds = std::chrono::duration<double>(elapsed).count();
+	this->achieved_rate.store(this->rate_window_generations / seconds);
+	this->rate_window_start = now;
+	this->rate_window_generations = 0;
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+#include <condition_variable>
+#include "Universe.h"
+
+class SimulationScheduler {
+public:
+	enum class OverrunPolicy {
+		CatchUp, // run missed generations back to back until the schedule is met again
+		Drop // skip missed generations and keep the original cadence
+	};
+
+	SimulationScheduler(Universe* universe, double target_rate = 5.0);
+	~SimulationScheduler();
+
+#pragma region Control
+public:
+	// ---- methods ----
+	void start();
+	void stop(); // request the simulation thread to stop, doesn't wait
+	void join(); // wait for the simulation thread to finish
+	bool isRunning() const;
+#pragma endregion
+
+#pragma region Configuration
+public:
+	// ---- methods ----
+	void setTargetRate(double generations_per_second);
+	double getTargetRate() const;
+	void setUnlimited(bool unlimited); // step as fast as possible, ignoring the target rate
+	bool isUnlimited() const;
+	void setOverrunPolicy(OverrunPolicy policy);
+	OverrunPolicy getOverrunPolicy() const;
+	void setStopOnCycle(bool stop); // stop by itself once the board becomes still or periodic
+#pragma endregion
+
+#pragma region Statistics
+public:
+	// ---- methods ----
+	double getAchievedRate() const; // measured generations per second
+	uint64_t getGenerationCount() const; // generations stepped since start
+	uint64_t getDroppedCount() const; // generations skipped by the drop policy since start
+#pragma endregion
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	// ---- methods ----
+	void run();
+	bool waitUntil(Clock::time_point deadline); // returns false if stopped while waiting
+	void updateAchievedRate(Clock::time_point now);
+
+	// ---- attributes ----
+	Universe* universe;
+	std::thread thread;
+	std::atomic<bool> running{false};
+	std::mutex wait_mutex;
+	std::condition_variable wait_cv;
+
+	std::atomic<double> target_rate;
+	std::atomic<bool> unlimited{false};
+	std::atomic<OverrunPolicy> overrun_policy{OverrunPolicy::Drop};
+	std::atomic<bool> stop_on_cycle{false};
+
+	std::atomic<double> achieved_rate{0.0};
+	std::atomic<uint64_t> generation_count{0};
+	std::atomic<uint64_t> dropped_count{0};
+	Clock::time_point rate_window_start;
+	uint64_t rate_window_generations = 0;
+
+	static constexpr int MAX_CATCH_UP = 5; // periods the catch up policy may fall behind before resyncing
+	static constexpr std::chrono::microseconds SPIN_MARGIN{1500}; // finish waits by yielding for better precision than the os sleep
+	static constexpr std::chrono::milliseconds RATE_WINDOW{500};
+	static constexpr std::chrono::milliseconds PUBLISH_INTERVAL{16}; // ~60 rendered generations per second in unlimited mode
+};
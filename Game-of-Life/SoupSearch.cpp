@@ -0,0 +1,107 @@
+#include "SoupSearch.h"
+#include "CommandLine.h"
+#include "Universe.h"
+#include "WorkStealingPool.h"
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+SoupSearch::SoupSearch(const Config& config) {
+	this->config = config;
+}
+
+void SoupSearch::run() {
+	this->results.assign(this->config.count, Result{});
+
+	auto start_time = std::chrono::steady_clock::now();
+	{
+		WorkStealingPool pool(this->config.threads);
+		for (unsigned int i = 0; i < this->config.count; i++) {
+			pool.submit([this, i]() {
+				this->results[i] = this->runSoup(this->config.first_seed + i);
+			}); // soups take very different times to settle, stealing keeps every core busy
+		}
+		pool.wait();
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+
+	this->soups_per_second = seconds > 0.0 ? this->config.count / seconds : 0.0;
+}
+
+SoupSearch::Result SoupSearch::runSoup(unsigned int seed) const {
+	Universe universe(this->config.width, this->config.height, 0);
+	universe.setHistoryEnabled(false); // nothing rewinds, don't pay for recording
+	universe.setThreadCount(1); // soups already run one per worker
+	universe.initialize(this->config.width, this->config.height, this->config.percent, seed);
+
+	Result result;
+	result.seed = seed;
+
+	universe.advance(this->config.max_generations, true); // stops as soon as the soup becomes still or periodic
+
+	CycleDetector::Result cycle = universe.getCycle();
+	result.final_population = universe.getStats().population;
+	result.period = cycle.found ? cycle.period : 0;
+	result.generations_to_stabilize = cycle.found ? cycle.start_generation : 0;
+	result.generations_run = universe.getGeneration();
+	return result;
+}
+
+bool SoupSearch::writeResults(const std::string& filename) const {
+	std::ofstream file(filename);
+	if (!file.is_open()) {
+		std::cerr << "ERROR: Couldn't write soup results to " << filename << std::endl;
+		return false;
+	} // exit if couldn't open file
+
+	file << "seed,final_population,period,generations_to_stabilize,generations_run" << '\n';
+	for (auto& result : this->results) {
+		file << result.seed << ',' << result.final_population << ',' << result.period << ','
+			<< result.generations_to_stabilize << ',' << result.generations_run << '\n';
+	}
+	return true;
+}
+
+const std::vector<SoupSearch::Result>& SoupSearch::getResults() const {
+	return this->results;
+}
+
+double SoupSearch::getSoupsPerSecond() const {
+	return this->soups_per_second;
+}
+
+bool SoupSearch::parseArguments(int argc, char* argv[], Config& config) {
+	bool parsed = CommandLine::parseOptions(argc, argv, [&config](const std::string& option, const std::string& value) {
+		if (option == "--width") config.width = static_cast<int>(CommandLine::toInteger(value, 1, INT32_MAX));
+		else if (option == "--height") config.height = static_cast<int>(CommandLine::toInteger(value, 1, INT32_MAX));
+		else if (option == "--percent") config.percent = static_cast<int>(CommandLine::toInteger(value, 0, 100));
+		else if (option == "--seed") config.first_seed = static_cast<unsigned int>(CommandLine::toInteger(value, 0, UINT32_MAX));
+		else if (option == "--count") config.count = static_cast<unsigned int>(CommandLine::toInteger(value, 1, MAX_COUNT));
+		else if (option == "--max-generations") config.max_generations = static_cast<uint64_t>(CommandLine::toInteger(value, 1, INT64_MAX));
+		else if (option == "--threads") config.threads = static_cast<unsigned int>(CommandLine::toInteger(value, 0, CommandLine::getMaxThreads()));
+		else if (option == "--output") config.output = value;
+		else return false;
+		return true;
+	});
+	if (!parsed) return false;
+
+	if (config.width <= 0 || config.height <= 0 || config.percent < 0 || config.percent > 100) {
+		std::cerr << "ERROR: Invalid soup size or density" << std::endl;
+		return false;
+	} // exit if soup can't be created
+
+	return true;
+}
+
+int SoupSearch::runFromArguments(int argc, char* argv[]) {
+	Config config;
+	if (!SoupSearch::parseArguments(argc, argv, config)) {
+		return 1;
+	}
+
+	SoupSearch search(config);
+	search.run();
+
+	std::cout << "Searched " << config.count << " soups at " << search.getSoupsPerSecond() << " soups/s" << std::endl;
+	return search.writeResults(config.output) ? 0 : 1;
+}
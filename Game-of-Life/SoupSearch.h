@@ -0,0 +1,46 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// runs many small random soups in parallel until each one stabilizes and records how they ended
+class SoupSearch {
+public:
+	struct Config {
+		int width = 16;
+		int height = 16;
+		int percent = 50;
+		unsigned int first_seed = 1;
+		unsigned int count = 1000;
+		uint64_t max_generations = 100000; // give up on soups that haven't stabilized by then
+		unsigned int threads = 0; // 0 uses every hardware thread
+		std::string output = "soups.csv";
+	};
+
+	struct Result {
+		unsigned int seed = 0;
+		int64_t final_population = 0;
+		uint64_t period = 0; // 0 if the soup never stabilized
+		uint64_t generations_to_stabilize = 0; // first generation of the final cycle
+		uint64_t generations_run = 0;
+	};
+
+	SoupSearch(const Config& config);
+
+	void run();
+	bool writeResults(const std::string& filename) const;
+	const std::vector<Result>& getResults() const;
+	double getSoupsPerSecond() const;
+
+	static bool parseArguments(int argc, char* argv[], Config& config); // --width, --height, --percent, --seed, --count, --max-generations, --threads, --output
+	static int runFromArguments(int argc, char* argv[]); // entry point for --soup-search, returns the process exit code
+
+	static constexpr int64_t MAX_COUNT = int64_t(1) << 24; // a result is kept for every soup
+
+private:
+	Result runSoup(unsigned int seed) const;
+
+	Config config;
+	std::vector<Result> results;
+	double soups_per_second = 0.0;
+};
@@ -0,0 +1,140 @@
+#include "Stamp.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+Stamp::Stamp(const SparsePattern& pattern) : cells(pattern.width, pattern.height) {
+	for (const std::pair<int, int>& cell : pattern.cells) {
+		if (cell.first >= 0 && cell.first < pattern.width && cell.second >= 0 && cell.second < pattern.height) {
+			this->cells.setAlive(cell.first, cell.second, true);
+		}
+	}
+}
+
+Stamp::Stamp(BitGrid cells) : cells(std::move(cells)) {
+}
+
+bool Stamp::loadFromFile(const std::string& filename, size_t max_bytes) {
+	std::ifstream file(filename, std::ios::binary);
+	if (!file.is_open()) {
+		std::cout << "ERROR: Couldn't open pattern file " << filename << std::endl;
+		return false;
+	} // exit if couldn't open file
+
+	return this->loadFromStream(file, PatternFile::detectFormat(filename, file), max_bytes);
+}
+
+bool Stamp::loadFromStream(std::istream& input, PatternFile::Format format, size_t max_bytes) {
+	if (format != PatternFile::Format::Dense) {
+		SparsePattern pattern;
+		size_t max_cells = max_bytes / sizeof(pattern.cells[0]); // the cell list mustn't outgrow the limit either
+		bool read = format == PatternFile::Format::Cells ? PatternFile::readCells(input, pattern, max_cells) : PatternFile::readLife106(input, pattern, max_cells);
+		if (!read || !Stamp::fitsBytes(pattern.width, pattern.height, max_bytes)) {
+			return false;
+		}
+
+		this->cells = BitGrid(); // release the old stamp before the new one is built
+		*this = Stamp(pattern);
+		return true;
+	} // the sparse formats only list live cells
+
+	int width = 0, height = 0;
+	if (!PatternFile::readDenseSize(input, width, height) || !Stamp::fitsBytes(width, height, max_bytes)) {
+		return false;
+	}
+
+	BitGrid grid(width, height); // a dense file's stamp is exactly its board, dead edges included
+	PatternFile::readDenseRows(input, grid, width, height);
+	this->cells = std::move(grid);
+	return true;
+}
+
+bool Stamp::loadFromText(const std::string& text, size_t max_bytes) {
+	std::istringstream input(text);
+	return this->loadFromStream(input, PatternFile::detectFormat("", input), max_bytes);
+}
+
+void Stamp::rotateClockwise() {
+	this->rotate(true);
+}
+
+void Stamp::rotateCounterClockwise() {
+	this->rotate(false);
+}
+
+void Stamp::flipHorizontal() {
+	int width = this->getWidth(), words = this->cells.getWordsPerRow();
+	int64_t padding = int64_t(64) * words - width; // columns past the right edge, they come first once reversed
+	std::vector<uint64_t> reversed(static_cast<size_t>(words));
+
+	for (int y = 0; y < this->getHeight(); y++) {
+		uint64_t* row = this->cells.row(y);
+		for (int k = 0; k < words; k++) {
+			reversed[k] = BitGrid::reverseBits(row[words - 1 - k]);
+		}
+		for (int k = 0; k < words; k++) {
+			row[k] = BitGrid::getBits(reversed.data(), words, 64 * k + padding);
+		} // shift the padding back past the right edge
+	}
+}
+
+void Stamp::flipVertical() {
+	int height = this->getHeight(), words = this->cells.getWordsPerRow();
+	for (int y = 0; y < height / 2; y++) {
+		std::swap_ranges(this->cells.row(y), this->cells.row(y) + words, this->cells.row(height - 1 - y));
+	}
+}
+
+const BitGrid& Stamp::getCells() const {
+	return this->cells;
+}
+
+int Stamp::getWidth() const {
+	return this->cells.getWidth();
+}
+
+int Stamp::getHeight() const {
+	return this->cells.getHeight();
+}
+
+bool Stamp::empty() const {
+	return this->cells.empty();
+}
+
+const char* Stamp::getModeName(StampMode mode) {
+	switch (mode) {
+	case StampMode::Or: return "or";
+	case StampMode::Xor: return "xor";
+	case StampMode::Replace: return "replace";
+	}
+	return "unknown";
+}
+
+void Stamp::rotate(bool clockwise) {
+	int width = this->getWidth(), height = this->getHeight(), words = this->cells.getWordsPerRow();
+	BitGrid rotated(height, width);
+
+	for (int y = 0; y < height; y++) {
+		const uint64_t* row = this->cells.row(y);
+		for (int k = 0; k < words; k++) {
+			for (uint64_t word = row[k]; word != 0; word &= word - 1) {
+				int x = 64 * k + BitGrid::countTrailingZeros(word);
+				if (clockwise) rotated.setAlive(height - 1 - y, x, true);
+				else rotated.setAlive(y, width - 1 - x, true);
+			}
+		} // one bit at a time, lowest first
+	}
+
+	this->cells = std::move(rotated);
+}
+
+bool Stamp::fitsBytes(int width, int height, size_t max_bytes) {
+	double bytes = static_cast<double>(BitGrid::getRowStride(width)) * sizeof(uint64_t) * height;
+	if (bytes > static_cast<double>(max_bytes)) {
+		std::cout << "ERROR: A " << width << " x " << height << " pattern is too large to place" << std::endl;
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+#include <istream>
+#include <string>
+#include "BitGrid.h"
+#include "PatternFile.h"
+
+// how a stamp combines with the cells already on the board
+enum class StampMode {
+	Or, // live cells of the pattern are added, the board's own stay
+	Xor, // live cells of the pattern toggle the board's
+	Replace // the pattern's whole rectangle, dead cells included, overwrites the board
+};
+
+// a pattern held as its own bit grid, so placing it on a board is a masked copy a word at a time
+// loaded from a file or text in any pattern format, rotations and flips are applied to the stamp before it's placed
+class Stamp {
+public:
+	Stamp() = default;
+	Stamp(const SparsePattern& pattern);
+	Stamp(BitGrid cells);
+
+	bool loadFromFile(const std::string& filename, size_t max_bytes); // format told apart like Universe::loadFromFile
+	bool loadFromStream(std::istream& input, PatternFile::Format format, size_t max_bytes); // false with an error printed if the input is malformed or the stamp would need more than max_bytes, the stamp is kept then
+	bool loadFromText(const std::string& text, size_t max_bytes); // format told apart by the first line, for pasting from the clipboard
+	void rotateClockwise();
+	void rotateCounterClockwise();
+	void flipHorizontal(); // mirror left to right
+	void flipVertical(); // mirror top to bottom
+
+	const BitGrid& getCells() const;
+	int getWidth() const;
+	int getHeight() const;
+	bool empty() const;
+
+	static const char* getModeName(StampMode mode);
+	static bool fitsBytes(int width, int height, size_t max_bytes); // whether a stamp this size fits max_bytes, prints an error if it doesn't
+
+private:
+	// ---- methods ----
+	void rotate(bool clockwise); // only visits live cells
+
+	// ---- attributes ----
+	BitGrid cells;
+};
@@ -0,0 +1,136 @@
+#include "ThreadAffinity.h"
+#include <algorithm>
+#include <thread>
+#include <utility>
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__linux__)
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+const std::vector<int>& ThreadAffinity::getCpus() {
+	return getTopology().cpus;
+}
+
+int ThreadAffinity::getNodeOfCpu(int cpu) {
+	const Topology& topology = getTopology();
+	for (size_t i = 0; i < topology.cpus.size(); i++) {
+		if (topology.cpus[i] == cpu) return topology.nodes[i];
+	}
+	return 0;
+}
+
+int ThreadAffinity::getNodeCount() {
+	return getTopology().node_count;
+}
+
+bool ThreadAffinity::pinCurrentThread(int cpu) {
+#if defined(_WIN32)
+	if (cpu < 0 || cpu >= static_cast<int>(sizeof(DWORD_PTR) * 8)) return false; // outside the first processor group
+	return SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << cpu) != 0;
+#elif defined(__linux__)
+	if (cpu < 0 || cpu >= CPU_SETSIZE) return false;
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+	(void)cpu;
+	return false;
+#endif
+}
+
+const ThreadAffinity::Topology& ThreadAffinity::getTopology() {
+	static const Topology topology = readTopology();
+	return topology;
+}
+
+ThreadAffinity::Topology ThreadAffinity::readTopology() {
+	std::vector<std::pair<int, int>> found; // node and cpu
+
+#if defined(_WIN32)
+	DWORD_PTR process_mask = 0, system_mask = 0;
+	if (!GetProcessAffinityMask(GetCurrentProcess(), &process_mask, &system_mask)) {
+		process_mask = ~DWORD_PTR(0);
+	}
+
+	ULONG highest_node = 0;
+	if (!GetNumaHighestNodeNumber(&highest_node)) {
+		highest_node = 0;
+	}
+
+	for (ULONG node = 0; node <= highest_node; node++) {
+		ULONGLONG node_mask = 0;
+		if (!GetNumaNodeProcessorMask(static_cast<UCHAR>(node), &node_mask)) continue;
+
+		for (int cpu = 0; cpu < static_cast<int>(sizeof(DWORD_PTR) * 8); cpu++) {
+			if ((node_mask & process_mask) >> cpu & 1) {
+				found.push_back({static_cast<int>(node), cpu});
+			}
+		}
+	} // first processor group only, which is all SetThreadAffinityMask can reach
+#elif defined(__linux__)
+	cpu_set_t allowed;
+	CPU_ZERO(&allowed);
+	if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+		std::vector<int> node_of(CPU_SETSIZE, 0);
+
+		if (DIR* directory = opendir("/sys/devices/system/node")) {
+			while (dirent* entry = readdir(directory)) {
+				int node = 0;
+				if (std::sscanf(entry->d_name, "node%d", &node) != 1) continue;
+
+				std::ifstream file(std::string("/sys/devices/system/node/") + entry->d_name + "/cpulist");
+				std::string list, range;
+				std::getline(file, list);
+
+				std::stringstream ranges(list);
+				while (std::getline(ranges, range, ',')) {
+					int first = 0, last = 0;
+					int fields = std::sscanf(range.c_str(), "%d-%d", &first, &last);
+					if (fields < 1) continue;
+					if (fields == 1) last = first;
+
+					for (int cpu = std::max(first, 0); cpu <= std::min(last, CPU_SETSIZE - 1); cpu++) {
+						node_of[cpu] = node;
+					}
+				} // cpulist looks like "0-7,16-23"
+			}
+			closedir(directory);
+		} // no sysfs node directory means a single node
+
+		for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+			if (CPU_ISSET(cpu, &allowed)) {
+				found.push_back({node_of[cpu], cpu});
+			}
+		}
+	}
+#endif
+
+	if (found.empty()) {
+		unsigned int count = std::max(1u, std::thread::hardware_concurrency());
+		for (unsigned int cpu = 0; cpu < count; cpu++) {
+			found.push_back({0, static_cast<int>(cpu)});
+		}
+	} // unknown topology, assume one node
+
+	std::sort(found.begin(), found.end()); // node by node
+
+	Topology topology;
+	topology.node_count = 0;
+	for (size_t i = 0; i < found.size(); i++) {
+		if (i == 0 || found[i].first != found[i - 1].first) {
+			topology.node_count++;
+		}
+		topology.nodes.push_back(found[i].first);
+		topology.cpus.push_back(found[i].second);
+	}
+	return topology;
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include <vector>
+
+// thread pinning and numa topology, everything degrades to "one node, no pinning" where the platform can't tell
+class ThreadAffinity {
+public:
+	static const std::vector<int>& getCpus(); // cpus this process may run on, ordered node by node so neighbouring workers share a node
+	static int getNodeOfCpu(int cpu); // 0 when unknown
+	static int getNodeCount();
+	static bool pinCurrentThread(int cpu); // returns false if the thread couldn't be pinned
+
+private:
+	struct Topology {
+		std::vector<int> cpus;
+		std::vector<int> nodes; // node of each cpu in cpus
+		int node_count = 1;
+	};
+
+	// ---- methods ----
+	static const Topology& getTopology(); // read once
+	static Topology readTopology();
+};
@@ -0,0 +1,325 @@
+#include "TileStepper.h"
+#include "WorkStealingPool.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <thread>
+
+TileStepper::TileStepper(int block_generations, int tile_rows, int tile_words, unsigned int thread_count) {
+	this->setBlockGenerations(block_generations);
+	this->setTileSize(tile_rows, tile_words);
+	this->setThreadCount(thread_count);
+}
+
+TileStepper::~TileStepper() {
+	delete this->pool;
+}
+
+void TileStepper::step(BitGrid& grid, BitGrid& scratch, uint64_t generations, GenerationStats& stats) {
+	stats = GenerationStats{};
+	this->tiles_stepped = 0;
+	this->tiles_skipped = 0;
+	if (scratch.getWidth() != grid.getWidth() || scratch.getHeight() != grid.getHeight()) {
+		this->allocate(scratch, grid.getWidth(), grid.getHeight());
+		this->tiles_valid = false;
+	} // every word of the scratch grid is overwritten by the first pass, its contents don't matter
+
+	if (grid.empty() || generations == 0) {
+		for (int y = 0; y < grid.getHeight(); y++) {
+			accumulateRow(y, 0, grid.row(y), grid.row(y), grid.getWordsPerRow(), stats);
+		}
+		return;
+	} // nothing to step, describe the board as it is
+
+	int tiles_x = (grid.getWordsPerRow() + this->tile_words - 1) / this->tile_words;
+	int tiles_y = (grid.getHeight() + this->tile_rows - 1) / this->tile_rows;
+	if (!this->tiles_valid || tiles_x != this->tiles_x || tiles_y != this->tiles_y) {
+		this->tiles_x = tiles_x;
+		this->tiles_y = tiles_y;
+		size_t tile_count = static_cast<size_t>(tiles_x) * tiles_y;
+		this->tile_changed.assign(tile_count, 1);
+		this->tile_stats.assign(tile_count, GenerationStats{});
+		this->previous_block = 0;
+	} // nothing is known about the board, every tile is stepped once
+
+	while (generations > 0) {
+		int block = static_cast<int>(std::min<uint64_t>(generations, this->block_generations));
+		this->stepPass(grid, scratch, block, block != this->previous_block); // skipping relies on the pass computing the same function as the last one
+
+		std::swap(grid, scratch);
+		generations -= block;
+		this->previous_block = block;
+	}
+	this->tiles_valid = true; // the next call can carry on, as long as nothing else touches the two grids
+
+	for (const GenerationStats& tile : this->tile_stats) {
+		stats.merge(tile);
+	} // tiles are disjoint, the order doesn't matter
+
+	if (Profiler::isEnabled()) {
+		Profiler::instance().counter("tiles stepped", static_cast<double>(this->tiles_stepped));
+		Profiler::instance().counter("tiles skipped", static_cast<double>(this->tiles_skipped));
+	}
+}
+
+void TileStepper::allocate(BitGrid& grid, int width, int height) {
+	grid.allocate(width, height);
+	if (grid.isFileBacked()) return; // already zero, and placement doesn't matter for pages that come from disk
+
+	int words = grid.getRowStride(); // the padding after each row has to be written too
+	int tile_rows = (grid.getHeight() + this->tile_rows - 1) / this->tile_rows;
+
+	auto clearRows = [this, &grid, words](int tile_row) {
+		int last_row = std::min((tile_row + 1) * this->tile_rows, grid.getHeight());
+		for (int y = tile_row * this->tile_rows; y < last_row; y++) {
+			std::fill(grid.row(y), grid.row(y) + words, 0);
+		}
+	};
+
+	if (!this->startPool(tile_rows)) {
+		for (int tile_row = 0; tile_row < tile_rows; tile_row++) {
+			clearRows(tile_row);
+		}
+		return;
+	}
+
+	for (int tile_row = 0; tile_row < tile_rows; tile_row++) {
+		this->pool->submitTo(this->getHomeWorker(tile_row, tile_rows), [&clearRows, tile_row]() {
+			clearRows(tile_row);
+		}); // the first write places the pages, so it has to come from the worker that will step them
+	}
+	this->pool->wait();
+}
+
+void TileStepper::markChanged(int x, int y) {
+	if (!this->tiles_valid) return;
+
+	int tile_x = x / 64 / this->tile_words;
+	int tile_y = y / this->tile_rows;
+	if (tile_x < 0 || tile_x >= this->tiles_x || tile_y < 0 || tile_y >= this->tiles_y) {
+		this->invalidate();
+		return;
+	} // not the board the tiles describe
+
+	this->tile_changed[static_cast<size_t>(tile_y) * this->tiles_x + tile_x] = 1; // steps it and its neighbours next pass
+}
+
+void TileStepper::invalidate() {
+	this->tiles_valid = false;
+}
+
+void TileStepper::setBlockGenerations(int generations) {
+	this->block_generations = std::clamp(generations, 1, 64);
+}
+
+void TileStepper::setTileSize(int rows, int words) {
+	this->tile_rows = std::max(rows, 1);
+	this->tile_words = std::max(words, 1);
+	this->tiles_valid = false;
+}
+
+void TileStepper::setThreadCount(unsigned int thread_count) {
+	if (thread_count == 0) {
+		thread_count = std::max(1u, std::thread::hardware_concurrency());
+	} // use every hardware thread by default
+
+	delete this->pool;
+	this->pool = nullptr;
+	this->thread_count = thread_count;
+	this->buffers.resize(1); // the calling thread's, workers get theirs when the pool starts
+}
+
+unsigned int TileStepper::getThreadCount() const {
+	return this->thread_count;
+}
+
+void TileStepper::setPinning(bool pin_threads) {
+	if (pin_threads == this->pin_threads) return;
+
+	this->pin_threads = pin_threads;
+	delete this->pool;
+	this->pool = nullptr; // restarted with the new setting when it's next needed
+}
+
+bool TileStepper::isPinning() const {
+	return this->pin_threads;
+}
+
+size_t TileStepper::getMemoryUsage() const {
+	size_t bytes = 0;
+	for (const Buffers& buffers : this->buffers) {
+		bytes += (buffers.current.capacity() + buffers.next.capacity() + buffers.zero_row.capacity()) * sizeof(uint64_t);
+	}
+	bytes += this->tile_changed.capacity() + this->next_changed.capacity() + this->active_tiles.capacity() * sizeof(int);
+	bytes += this->tile_stats.capacity() * sizeof(GenerationStats);
+	return bytes;
+}
+
+uint64_t TileStepper::getTilesStepped() const {
+	return this->tiles_stepped;
+}
+
+uint64_t TileStepper::getTilesSkipped() const {
+	return this->tiles_skipped;
+}
+
+void TileStepper::stepPass(const BitGrid& source, BitGrid& target, int generations, bool all_active) {
+	// a tile computes its output from itself and the halo around it, if none of those tiles changed in the last pass
+	// it gets the same input and produces the same output as last time, which was its current state,
+	// and the target grid still holds that state from two swaps ago, so it can be left alone
+	int reach = (generations + this->tile_rows - 1) / this->tile_rows; // tile rows the halo reaches into, the side halo never passes one tile
+	this->active_tiles.clear();
+	for (int ty = 0; ty < this->tiles_y; ty++) {
+		for (int tx = 0; tx < this->tiles_x; tx++) {
+			bool active = all_active;
+			for (int ny = std::max(ty - reach, 0); !active && ny <= std::min(ty + reach, this->tiles_y - 1); ny++) {
+				for (int nx = std::max(tx - 1, 0); !active && nx <= std::min(tx + 1, this->tiles_x - 1); nx++) {
+					active = this->tile_changed[static_cast<size_t>(ny) * this->tiles_x + nx] != 0;
+				}
+			}
+
+			if (active) {
+				this->active_tiles.push_back(ty * this->tiles_x + tx);
+			}
+		}
+	}
+
+	this->next_changed.assign(this->tile_changed.size(), 0);
+	this->tiles_stepped += this->active_tiles.size();
+	this->tiles_skipped += this->tile_changed.size() - this->active_tiles.size();
+
+	if (this->startPool(static_cast<int>(this->active_tiles.size()))) {
+		for (int index : this->active_tiles) {
+			this->pool->submitTo(this->getHomeWorker(index / this->tiles_x, this->tiles_y), [this, &source, &target, index, generations]() {
+				this->stepTileAt(source, target, index, generations);
+			}); // tiles start on the worker whose node holds them, idle workers steal whatever the busy ones haven't reached yet
+		}
+		this->pool->wait();
+	} else {
+		for (int index : this->active_tiles) {
+			this->stepTileAt(source, target, index, generations);
+		}
+	}
+
+	std::swap(this->tile_changed, this->next_changed);
+}
+
+void TileStepper::stepTileAt(const BitGrid& source, BitGrid& target, int index, int generations) {
+	int row = (index / this->tiles_x) * this->tile_rows;
+	int word = (index % this->tiles_x) * this->tile_words;
+	Tile tile = {row, std::min(row + this->tile_rows, source.getHeight()), word, std::min(word + this->tile_words, source.getWordsPerRow())};
+
+	GenerationStats& stats = this->tile_stats[index];
+	stats = GenerationStats{};
+	this->next_changed[index] = this->stepTile(source, target, tile, generations, this->getBuffers(), stats); // every task writes its own elements
+}
+
+bool TileStepper::stepTile(const BitGrid& source, BitGrid& target, const Tile& tile, int generations, Buffers& buffers, GenerationStats& stats) {
+	// the halo is deep enough that errors creeping in from the buffer's edges never reach the written part,
+	// edges that are also board edges are exact because everything past the board is dead
+	int halo_top = std::min(generations, tile.first_row);
+	int halo_bottom = std::min(generations, source.getHeight() - tile.last_row);
+	int halo_left = tile.first_word > 0 ? 1 : 0;
+	int halo_right = tile.last_word < source.getWordsPerRow() ? 1 : 0;
+
+	int first_row = tile.first_row - halo_top;
+	int rows = tile.last_row + halo_bottom - first_row;
+	int first_word = tile.first_word - halo_left;
+	int words = tile.last_word + halo_right - first_word;
+	int tile_words = tile.last_word - tile.first_word;
+	uint64_t last_mask = (first_word + words == source.getWordsPerRow()) ? source.getLastWordMask() : ~uint64_t(0);
+
+	bool empty = true;
+	for (int y = 0; y < rows && empty; y++) {
+		const uint64_t* row = source.row(first_row + y) + first_word;
+		empty = std::all_of(row, row + words, [](uint64_t word) { return word == 0; });
+	}
+
+	if (empty) {
+		for (int y = tile.first_row; y < tile.last_row; y++) {
+			uint64_t* row = target.row(y);
+			if (std::any_of(row + tile.first_word, row + tile.last_word, [](uint64_t word) { return word != 0; })) {
+				std::fill(row + tile.first_word, row + tile.last_word, 0);
+			} // rows that are already dead stay clean, a backing file never has to write them back
+		}
+		return false;
+	} // nothing can be born without live cells in reach, the tile stays dead and has nothing to count
+
+	buffers.current.resize(static_cast<size_t>(rows) * words);
+	buffers.next.resize(static_cast<size_t>(rows) * words);
+	if (buffers.zero_row.size() < static_cast<size_t>(words)) {
+		buffers.zero_row.assign(words, 0);
+	}
+
+	for (int y = 0; y < rows; y++) {
+		const uint64_t* row = source.row(first_row + y) + first_word;
+		std::copy(row, row + words, buffers.current.data() + static_cast<size_t>(y) * words);
+	} // copy the tile and its halo
+
+	for (int generation = 1; generation <= generations; generation++) {
+		// rows near a halo edge go stale one row per generation, skip them (trapezoid)
+		int begin = (first_row > 0) ? generation : 0;
+		int end = (first_row + rows < source.getHeight()) ? rows - generation : rows;
+
+		for (int y = begin; y < end; y++) {
+			const uint64_t* above = y > 0 ? buffers.current.data() + static_cast<size_t>(y - 1) * words : buffers.zero_row.data();
+			const uint64_t* below = y + 1 < rows ? buffers.current.data() + static_cast<size_t>(y + 1) * words : buffers.zero_row.data();
+			BitGrid::stepRow(above, buffers.current.data() + static_cast<size_t>(y) * words, below, buffers.next.data() + static_cast<size_t>(y) * words, words, last_mask);
+		}
+
+		std::swap(buffers.current, buffers.next);
+	}
+
+	bool changed = false;
+	for (int y = tile.first_row; y < tile.last_row; y++) {
+		const uint64_t* row = buffers.current.data() + static_cast<size_t>(y - first_row) * words + halo_left;
+		changed = changed || !std::equal(row, row + tile_words, source.row(y) + tile.first_word);
+		std::copy(row, row + tile_words, target.row(y) + tile.first_word);
+
+		const uint64_t* previous = buffers.next.data() + static_cast<size_t>(y - first_row) * words + halo_left; // holds the generation before the last
+		accumulateRow(y, tile.first_word, previous, row, tile_words, stats); // every pass, a skipped tile keeps reporting these
+	} // write back the part of the tile the halo kept exact
+
+	return changed;
+}
+
+bool TileStepper::startPool(int tile_count) {
+	if (this->thread_count <= 1 || tile_count <= 1) return false;
+
+	if (!this->pool) {
+		this->pool = new WorkStealingPool(this->thread_count, this->pin_threads);
+		this->buffers.resize(this->pool->getThreadCount() + 1);
+	} // only boards big enough to have several tiles ever start the threads
+	return true;
+}
+
+unsigned int TileStepper::getHomeWorker(int tile_row, int tile_rows) const {
+	return static_cast<unsigned int>(static_cast<int64_t>(tile_row) * this->thread_count / std::max(tile_rows, 1));
+}
+
+TileStepper::Buffers& TileStepper::getBuffers() {
+	int worker = this->pool ? this->pool->getCurrentWorkerIndex() : -1;
+	return worker >= 0 ? this->buffers[worker] : this->buffers.back();
+}
+
+void TileStepper::accumulateRow(int y, int first_word, const uint64_t* previous, const uint64_t* next, int words, GenerationStats& stats) {
+	int first_live = -1, last_live = -1;
+	for (int i = 0; i < words; i++) {
+		int k = first_word + i;
+		uint64_t before = previous[i], after = next[i];
+		stats.births += BitGrid::popCount(after & ~before);
+		stats.deaths += BitGrid::popCount(before & ~after);
+
+		if (after) {
+			stats.population += BitGrid::popCount(after);
+			stats.hash ^= BitGrid::wordHash(y, k, after);
+			if (first_live < 0) {
+				first_live = 64 * k + BitGrid::countTrailingZeros(after);
+			}
+			last_live = 64 * k + 63 - BitGrid::countLeadingZeros(after);
+		}
+	}
+
+	if (first_live >= 0) {
+		stats.addLiveSpan(first_live, last_live, y);
+	}
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "BitGrid.h"
+#include "GenerationStats.h"
+
+class WorkStealingPool;
+
+// advances a board several generations per pass over memory (temporal blocking)
+// each tile is copied with a halo deep enough for the whole block, stepped in cache and written back,
+// so a block of k generations reads and writes the board once instead of k times
+// tiles run on a work stealing pool, and after the first pass only tiles near a change are stepped at all,
+// so a small active pattern on a huge board costs about as much as the pattern
+// every band of tile rows has a home worker that first touches its memory and is handed its tiles,
+// with pinned workers that keeps each band on the numa node that steps it
+// what's known about the tiles carries over to the next call, so the owner has to report anything else that writes to the grids
+class TileStepper {
+public:
+	TileStepper(int block_generations = 8, int tile_rows = 128, int tile_words = 32, unsigned int thread_count = 0);
+	~TileStepper();
+	TileStepper(const TileStepper&) = delete;
+	TileStepper& operator=(const TileStepper&) = delete;
+
+	void step(BitGrid& grid, BitGrid& scratch, uint64_t generations, GenerationStats& stats); // result ends up in grid, stats describe the final generation
+	void allocate(BitGrid& grid, int width, int height); // empty board whose bands are first touched by their home workers
+	void markChanged(int x, int y); // a cell of the grid was edited between calls
+	void invalidate(); // either grid was replaced or written some other way, the next call steps every tile
+	void setBlockGenerations(int generations); // generations per pass, at most 64 because the side halo is one word
+	void setTileSize(int rows, int words);
+	void setThreadCount(unsigned int thread_count); // 0 uses every hardware thread, 1 steps on the calling thread only
+	unsigned int getThreadCount() const;
+	void setPinning(bool pin_threads); // pin workers to cpus, on by default
+	bool isPinning() const;
+	size_t getMemoryUsage() const; // tile buffers kept between calls
+	uint64_t getTilesStepped() const; // tiles stepped by the last call, counted once per pass
+	uint64_t getTilesSkipped() const; // tiles the last call left alone because nothing near them changed
+
+	static void accumulateRow(int y, int first_word, const uint64_t* previous, const uint64_t* next, int words, GenerationStats& stats); // stats of words [first_word, first_word + words) of a row, the pointers start at first_word
+
+private:
+	struct Tile {
+		int first_row, last_row; // rows written back, exclusive end
+		int first_word, last_word; // words written back, exclusive end
+	};
+
+	struct Buffers {
+		std::vector<uint64_t> current; // tile with its halo, stepped in place between the two buffers
+		std::vector<uint64_t> next;
+		std::vector<uint64_t> zero_row;
+	};
+
+	// ---- methods ----
+	void stepPass(const BitGrid& source, BitGrid& target, int generations, bool all_active);
+	void stepTileAt(const BitGrid& source, BitGrid& target, int index, int generations);
+	bool stepTile(const BitGrid& source, BitGrid& target, const Tile& tile, int generations, Buffers& buffers, GenerationStats& stats); // returns whether the tile changed
+	bool startPool(int tile_count); // returns false if the work is better done on the calling thread
+	unsigned int getHomeWorker(int tile_row, int tile_rows) const; // tile rows are split into one contiguous band per worker
+	Buffers& getBuffers(); // buffers of the calling thread
+
+	// ---- attributes ----
+	int block_generations;
+	int tile_rows;
+	int tile_words;
+	unsigned int thread_count;
+	bool pin_threads = true;
+	WorkStealingPool* pool = nullptr; // started the first time a pass has more than one tile to step
+	std::vector<Buffers> buffers; // one per worker, the last one for the calling thread
+
+	int tiles_x = 0;
+	int tiles_y = 0;
+	std::vector<uint8_t> tile_changed; // whether the last pass changed each tile
+	std::vector<uint8_t> next_changed; // filled in by the current pass
+	std::vector<GenerationStats> tile_stats; // stats of each tile's latest generation, still valid for tiles that are skipped
+	std::vector<int> active_tiles;
+	bool tiles_valid = false; // tile_changed and tile_stats describe the grids passed to the last call
+	int previous_block = 0; // generations per pass in the last pass
+	uint64_t tiles_stepped = 0;
+	uint64_t tiles_skipped = 0;
+};
@@ -1,4 +1,5 @@
 #include "UI.h"
+#include "ResourceCache.h"
 #include <algorithm>
 #include <windows.h>
 #include <string>
@@ -68,19 +69,16 @@ void UI::Button::renderBody(SDL_Renderer* renderer) {
 }
 
 void UI::Button::renderText(SDL_Renderer* renderer) {
-	auto font_path = getExecutableDirectory() + "\\assets\\arialbd.ttf";
-	TTF_Font* font = TTF_OpenFont(font_path.c_str(), 14);
+	static const std::string font_path = getExecutableDirectory() + "\\assets\\arialbd.ttf";
+	TTF_Font* font = ResourceCache::instance().getFont(font_path, 14);
 
 	if (!font) return; // exit if can't load font
 
-	SDL_Surface* text_surface = TTF_RenderText_Solid(font, this->text.c_str(), {font_color.r, font_color.g, font_color.b});
-	SDL_Texture* text_texture = SDL_CreateTextureFromSurface(renderer, text_surface);
-	SDL_Rect text_rect = {this->x + (this->width - text_surface->w) / 2, this->y + (this->height - text_surface->h) / 2, text_surface->w, text_surface->h};
+	TextTexture text_texture = ResourceCache::instance().getText(renderer, font, this->text, {font_color.r, font_color.g, font_color.b}, TextMode::Solid);
+	if (!text_texture.texture) return; // exit if text couldn't be rendered
 
-	SDL_RenderCopy(renderer, text_texture, nullptr, &text_rect);
-	SDL_FreeSurface(text_surface);
-	SDL_DestroyTexture(text_texture);
-	TTF_CloseFont(font);
+	SDL_Rect text_rect = {this->x + (this->width - text_texture.width) / 2, this->y + (this->height - text_texture.height) / 2, text_texture.width, text_texture.height};
+	SDL_RenderCopy(renderer, text_texture.texture, nullptr, &text_rect);
 }
 #pragma endregion
 
@@ -220,13 +218,11 @@ UI::NumericTextBox::ID UI::NumericTextBox::getID() {
 }
 
 void UI::NumericTextBox::renderLabel(SDL_Renderer* renderer) {
-	SDL_Surface* label_surface = TTF_RenderText_Solid(this->font, this->label.c_str(), {26, 26, 25, 255});
-	SDL_Texture* label_texture = SDL_CreateTextureFromSurface(renderer, label_surface);
-	SDL_Rect label_rect = {this->x, this->y - label_surface->h - 5, label_surface->w, label_surface->h};
+	TextTexture label_texture = ResourceCache::instance().getText(renderer, this->font, this->label, {26, 26, 25, 255}, TextMode::Solid);
+	if (!label_texture.texture) return; // exit if label couldn't be rendered
 
-	SDL_RenderCopy(renderer, label_texture, nullptr, &label_rect);
-	SDL_FreeSurface(label_surface);
-	SDL_DestroyTexture(label_texture);
+	SDL_Rect label_rect = {this->x, this->y - label_texture.height - 5, label_texture.width, label_texture.height};
+	SDL_RenderCopy(renderer, label_texture.texture, nullptr, &label_rect);
 }
 
 void UI::NumericTextBox::renderBody(SDL_Renderer* renderer) {
@@ -237,13 +233,11 @@ void UI::NumericTextBox::renderBody(SDL_Renderer* renderer) {
 
 void UI::NumericTextBox::renderText(SDL_Renderer* renderer) {
 	if (!this->text.empty()) {
-		SDL_Surface* text_surface = TTF_RenderText_Blended(this->font, this->text.c_str(), {26, 26, 25});
-		SDL_Texture* text_texture = SDL_CreateTextureFromSurface(renderer, text_surface);
-		SDL_Rect text_rect = {this->x + 5, this->y + (this->height - text_surface->h) / 2, text_surface->w, text_surface->h};
+		TextTexture text_texture = ResourceCache::instance().getText(renderer, this->font, this->text, {26, 26, 25}, TextMode::Blended);
+		if (!text_texture.texture) return; // exit if text couldn't be rendered
 
-		SDL_RenderCopy(renderer, text_texture, nullptr, &text_rect);
-		SDL_FreeSurface(text_surface);
-		SDL_DestroyTexture(text_texture);
+		SDL_Rect text_rect = {this->x + 5, this->y + (this->height - text_texture.height) / 2, text_texture.width, text_texture.height};
+		SDL_RenderCopy(renderer, text_texture.texture, nullptr, &text_rect);
 	}
 }
 
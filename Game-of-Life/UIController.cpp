@@ -1,4 +1,6 @@
 #include "UIController.h"
+#include "ResourceCache.h"
+#include "Profiler.h"
 #include <iostream>
 #include <algorithm>
 #define NOMINMAX
@@ -6,12 +8,17 @@
 #include <commdlg.h>
 #include <locale>
 #include <codecvt>
+#include <cstdio>
 
 unsigned int UIController::dialog_close_time = 0;
 UIController::UIController(Universe* universe, int window_width, int window_height, GridView* grid_view) {
 	this->init(universe, window_width, window_height, grid_view);
 }
 
+UIController::~UIController() {
+	delete this->scheduler; // stops and joins the simulation thread
+}
+
 #pragma region Input Handling
 void UIController::handleInput(const SDL_Event& event) {
 	if (this->isHelpWindowOpen()) {
@@ -45,6 +52,10 @@ bool UIController::isInsidePanel(int mouse_x, int mouse_y) {
 	return mouse_x >= (this->window_width - this->panel_width) && mouse_x < this->window_width;
 }
 
+int UIController::getRandomPercent() {
+	return this->textboxes[2]->getValue();
+}
+
 // ---- button handling ----
 void UIController::handleButtonInputs(const SDL_Event& event, int mouse_x, int mouse_y, uint32_t current_time, double elapsed_time) {
 	UI::Button* hovered_button = nullptr;
@@ -66,6 +77,18 @@ void UIController::handleButtonInputs(const SDL_Event& event, int mouse_x, int m
 		this->handleButtonAction(hovered_button);
 		this->last_button_press = current_time;
 	}
+
+	// right click on next changes how many generations it steps
+	if (hovered_button && hovered_button->getID() == UI::Button::ID::Next && event.button.button == SDL_BUTTON_RIGHT && elapsed_time >= this->action_time) {
+		this->cycleNextStepCount(hovered_button);
+		this->last_button_press = current_time;
+	}
+}
+
+void UIController::cycleNextStepCount(UI::Button* button) {
+	this->next_step_index = (this->next_step_index + 1) % (sizeof(NEXT_STEP_COUNTS) / sizeof(NEXT_STEP_COUNTS[0]));
+	uint64_t count = NEXT_STEP_COUNTS[this->next_step_index];
+	button->setText(count == 1 ? "Next" : "Next x" + std::to_string(count));
 }
 void UIController::handleButtonAction(UI::Button* button) {
 	switch (button->getID()) {
@@ -86,7 +109,7 @@ void UIController::handleButtonAction(UI::Button* button) {
 		}
 
 		case UI::Button::ID::Next: {
-			this->universe->nextGeneration();
+			this->universe->advance(NEXT_STEP_COUNTS[this->next_step_index]); // one lock and one publish however many generations
 			break;
 		}
 
@@ -98,10 +121,11 @@ void UIController::handleButtonAction(UI::Button* button) {
 		case UI::Button::ID::Load: {
 			std::string filename = this->convertWStringToString(this->openLoadFileDialog());
 			this->dialog_close_time = SDL_GetTicks();
-			this->universe->loadFromFile(filename);
-			this->grid_view->recenter();
-			this->textboxes[0]->setText(std::to_string(this->universe->getWidth()));
-			this->textboxes[1]->setText(std::to_string(this->universe->getHeight()));
+			if (this->universe->loadFromFile(filename)) {
+				this->grid_view->recenter();
+				this->textboxes[0]->setText(std::to_string(this->universe->getWidth()));
+				this->textboxes[1]->setText(std::to_string(this->universe->getHeight()));
+			} // keep the current board if loading failed
 			break;
 		}
 
@@ -126,8 +150,12 @@ void UIController::handleButtonAction(UI::Button* button) {
 		}
 
 		case UI::Button::ID::Confirm: {
-			this->universe->setGridSize(this->textboxes[0]->getValue(), this->textboxes[1]->getValue());
-			this->grid_view->recenter();
+			if (this->universe->setGridSize(this->textboxes[0]->getValue(), this->textboxes[1]->getValue())) {
+				this->grid_view->recenter();
+			} else {
+				this->textboxes[0]->setText(std::to_string(this->universe->getWidth()));
+				this->textboxes[1]->setText(std::to_string(this->universe->getHeight()));
+			} // show the size that's actually in use
 			break;
 		}
 
@@ -232,12 +260,13 @@ void UIController::adjustGridSizeTextboxValues() {
 	int width = this->textboxes[0]->getValue();
 	int height = this->textboxes[1]->getValue();
 
-	// product must not exceed 10000000
-	while ((long long) width * height > 10000000) {
+	// product must fit the universe's memory budget, shrink the larger side
+	int64_t max_cells = this->universe->getMaxCells();
+	if (static_cast<int64_t>(width) * height > max_cells) {
 		if (width > height) {
-			width--;
+			width = static_cast<int>(std::max<int64_t>(5, max_cells / height));
 		} else {
-			height--;
+			height = static_cast<int>(std::max<int64_t>(5, max_cells / width));
 		}
 		this->textboxes[0]->setText(std::to_string(width));
 		this->textboxes[1]->setText(std::to_string(height));
@@ -263,14 +292,22 @@ void UIController::handleSliderDrag(const SDL_Event& event, int mouse_x, int mou
 	if (event.type == SDL_MOUSEMOTION && (event.motion.state & SDL_BUTTON_LMASK)) {
 		if (this->speed_slider->isBodyHovered(mouse_x, mouse_y)) {
 			this->speed_slider->setKnobPosition(mouse_x); // change slider knob position to mouse position
-			this->generations_per_second = this->speed_slider->getValue(); // update playback speed
+			this->applySpeedSliderValue(); // update playback speed
 		}
 	}
 }
+
+void UIController::applySpeedSliderValue() {
+	int value = this->speed_slider->getValue();
+	this->scheduler->setUnlimited(value >= MAX_SPEED_VALUE); // last notch never sleeps
+	this->scheduler->setStopOnCycle(value >= MAX_SPEED_VALUE); // and stops once nothing new can happen
+	this->scheduler->setTargetRate(value);
+}
 #pragma endregion
 
 #pragma region Rendering & UI
 void UIController::render(SDL_Renderer* renderer) {
+	PROFILE_SCOPE("UIController::render");
 	// render panel
 	SDL_Rect panel = {
 		this->window_width - this->panel_width,
@@ -294,6 +331,202 @@ void UIController::render(SDL_Renderer* renderer) {
 
 	// render slider
 	this->speed_slider->render(renderer);
+
+	// render speed readout
+	this->renderSpeedReadout(renderer);
+
+	// render performance overlay
+	if (this->hud_visible) {
+		this->renderHud(renderer);
+	}
+
+	// render the latest message
+	this->renderMessage(renderer);
+}
+
+void UIController::update() {
+	if (!this->scheduler->isRunning()) {
+		this->universe->applyPendingEdits();
+	} // the simulation thread applies edits between generations while playing
+
+	for (auto button : this->buttons) {
+		if (button->getID() == UI::Button::ID::Stop && !this->scheduler->isRunning()) {
+			this->scheduler->join();
+			button->setText("Play");
+			button->setID(UI::Button::ID::Play);
+			this->lockDestructiveButtons(false);
+		}
+	} // the scheduler stopped by itself (e.g. the board became periodic)
+}
+
+void UIController::renderSpeedReadout(SDL_Renderer* renderer) {
+	if (SDL_GetTicks() - this->last_readout_update >= READOUT_INTERVAL || this->readout_lines.empty()) {
+		this->updateSpeedReadout();
+		this->last_readout_update = SDL_GetTicks();
+	} // refresh a few times per second so the cached text isn't re-rendered every frame
+
+	static const std::string font_path = UI::getExecutableDirectory() + "\\assets\\arial.ttf";
+	TTF_Font* font = UI::ResourceCache::instance().getFont(font_path, 11);
+
+	int line_height = this->readout_rect.h / static_cast<int>(this->readout_lines.size());
+	int y = this->readout_rect.y;
+	for (auto& line : this->readout_lines) {
+		UI::TextTexture text = UI::ResourceCache::instance().getText(renderer, font, line, {26, 26, 25, 255}, UI::TextMode::Blended);
+		if (text.texture) {
+			SDL_Rect text_rect = {this->readout_rect.x, y + (line_height - text.height) / 2, text.width, text.height};
+			SDL_RenderCopy(renderer, text.texture, nullptr, &text_rect);
+		}
+		y += line_height; // move to next line
+	}
+}
+
+void UIController::updateSpeedReadout() {
+	double achieved = this->scheduler->getAchievedRate();
+	double cells = static_cast<double>(this->universe->getWidth()) * this->universe->getHeight();
+	std::string target = this->scheduler->isUnlimited() ? "max" : this->formatCount(this->scheduler->getTargetRate());
+
+	CycleDetector::Result cycle = this->universe->getCycle();
+	std::string cycle_text = !cycle.found ? "none" : (cycle.period == 1 ? "still" : "period " + std::to_string(cycle.period));
+
+	this->readout_lines = {
+		"gen/s: " + this->formatCount(achieved),
+		"target: " + target,
+		"cells/s: " + this->formatCount(achieved * cells),
+		"cycle: " + cycle_text
+	};
+}
+
+void UIController::toggleHud() {
+	this->hud_visible = !this->hud_visible;
+	this->hud_lines.clear();
+	this->last_frame = Profiler::Clock::now();
+	Profiler::instance().setEnabled(this->hud_visible); // timers cost nothing while the overlay is hidden
+}
+
+bool UIController::isHudVisible() const {
+	return this->hud_visible;
+}
+
+void UIController::renderHud(SDL_Renderer* renderer) {
+	Profiler::Clock::time_point now = Profiler::Clock::now();
+	Profiler::instance().record("frame", this->last_frame, now); // time between panel renders is the frame time
+	this->last_frame = now;
+
+	if (SDL_GetTicks() - this->last_hud_update >= READOUT_INTERVAL || this->hud_lines.empty()) {
+		this->updateHud();
+		this->last_hud_update = SDL_GetTicks();
+	} // same refresh rate as the speed readout
+
+	SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+	SDL_SetRenderDrawColor(renderer, 26, 26, 25, 225);
+	SDL_RenderFillRect(renderer, &this->hud_rect);
+	SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+
+	static const std::string font_path = UI::getExecutableDirectory() + "\\assets\\arial.ttf";
+	TTF_Font* font = UI::ResourceCache::instance().getFont(font_path, 11);
+
+	int padding = 6;
+	int line_height = (this->hud_rect.h - 2 * padding) / static_cast<int>(this->hud_lines.size());
+	int y = this->hud_rect.y + padding;
+	for (auto& line : this->hud_lines) {
+		UI::TextTexture text = UI::ResourceCache::instance().getText(renderer, font, line, {249, 252, 223, 255}, UI::TextMode::Blended);
+		if (text.texture) {
+			SDL_Rect text_rect = {this->hud_rect.x + padding, y + (line_height - text.height) / 2, text.width, text.height};
+			SDL_RenderCopy(renderer, text.texture, nullptr, &text_rect);
+		}
+		y += line_height; // move to next line
+	}
+}
+
+void UIController::showMessage(const std::vector<std::string>& lines) {
+	this->message_lines = lines;
+	this->message_time = SDL_GetTicks();
+}
+
+void UIController::renderMessage(SDL_Renderer* renderer) {
+	if (this->message_lines.empty()) return;
+	if (SDL_GetTicks() - this->message_time >= MESSAGE_DURATION) {
+		this->message_lines.clear();
+		return;
+	} // exit once the message has been up long enough
+
+	static const std::string font_path = UI::getExecutableDirectory() + "\\assets\\arial.ttf";
+	TTF_Font* font = UI::ResourceCache::instance().getFont(font_path, 12);
+
+	int padding = 6, line_height = 16;
+	int height = 2 * padding + line_height * static_cast<int>(this->message_lines.size());
+	SDL_Rect box = {padding, this->window_height - height - padding, this->window_width - this->panel_width - 2 * padding, height}; // along the bottom of the board
+
+	SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+	SDL_SetRenderDrawColor(renderer, 26, 26, 25, 225);
+	SDL_RenderFillRect(renderer, &box);
+	SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+
+	int y = box.y + padding;
+	for (auto& line : this->message_lines) {
+		UI::TextTexture text = UI::ResourceCache::instance().getText(renderer, font, line, {249, 252, 223, 255}, UI::TextMode::Blended);
+		if (text.texture) {
+			SDL_Rect text_rect = {box.x + padding, y + (line_height - text.height) / 2, std::min(text.width, box.w - 2 * padding), text.height};
+			SDL_Rect source_rect = {0, 0, text_rect.w, text.height}; // long lines are cut at the edge of the box
+			SDL_RenderCopy(renderer, text.texture, &source_rect, &text_rect);
+		}
+		y += line_height; // move to next line
+	}
+}
+
+void UIController::updateHud() {
+	Profiler& profiler = Profiler::instance();
+	Profiler::Summary frame = profiler.getSummary("frame");
+	Profiler::Summary step = profiler.getSummary("step");
+	Profiler::Summary grid_wait = profiler.getSummary("grid_mutex wait");
+	Profiler::Summary rendering_wait = profiler.getSummary("rendering_mutex wait");
+	GenerationStats stats = this->universe->getStats();
+
+	std::string target = this->scheduler->isUnlimited() ? "max" : this->formatCount(this->scheduler->getTargetRate());
+
+	this->hud_lines = {
+		"frame: " + this->formatMilliseconds(frame.mean_ms) + " (p95 " + this->formatMilliseconds(frame.p95_ms) + ")",
+		"gen/s: " + this->formatCount(this->scheduler->getAchievedRate()) + " / " + target,
+		"step p50: " + this->formatMilliseconds(step.p50_ms),
+		"step p95: " + this->formatMilliseconds(step.p95_ms) + "  p99: " + this->formatMilliseconds(step.p99_ms),
+		"grid wait: " + this->formatMilliseconds(grid_wait.p95_ms) + " p95 (" + this->formatCount(static_cast<double>(grid_wait.count)) + ")",
+		"render wait: " + this->formatMilliseconds(rendering_wait.p95_ms) + " p95 (" + this->formatCount(static_cast<double>(rendering_wait.count)) + ")",
+		"population: " + this->formatCount(static_cast<double>(stats.population)),
+		"generation: " + this->formatCount(static_cast<double>(stats.generation)),
+		"memory: " + this->formatBytes(static_cast<double>(this->universe->getMemoryUsage().total()))
+	};
+}
+
+std::string UIController::formatBytes(double bytes) {
+	static const char* units[] = {"B", "KB", "MB", "GB", "TB"};
+	int unit = 0;
+	while (bytes >= 1024.0 && unit < 4) {
+		bytes /= 1024.0;
+		unit++;
+	} // scale to the largest unit that keeps the value below 1024
+
+	char buffer[32];
+	snprintf(buffer, sizeof(buffer), unit > 0 ? "%.1f %s" : "%.0f %s", bytes, units[unit]);
+	return buffer;
+}
+
+std::string UIController::formatMilliseconds(double ms) {
+	char buffer[32];
+	snprintf(buffer, sizeof(buffer), ms < 10.0 ? "%.2f ms" : "%.0f ms", ms);
+	return buffer;
+}
+
+std::string UIController::formatCount(double value) {
+	static const char* suffixes[] = {"", "K", "M", "G", "T"};
+	int suffix = 0;
+	while (value >= 1000.0 && suffix < 4) {
+		value /= 1000.0;
+		suffix++;
+	} // scale to the largest suffix that keeps the value below 1000
+
+	char buffer[32];
+	snprintf(buffer, sizeof(buffer), (value < 10.0 && suffix > 0) ? "%.1f%s" : "%.0f%s", value, suffixes[suffix]);
+	return buffer;
 }
 #pragma endregion
 
@@ -309,11 +542,12 @@ void UIController::renderHelpWindow() {
 }
 
 void UIController::openHelpWindow() {
-	this->help_window = SDL_CreateWindow("Help", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, 800, 400, SDL_WINDOW_SHOWN);
+	this->help_window = SDL_CreateWindow("Help", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, 800, 550, SDL_WINDOW_SHOWN);
 	this->help_renderer = SDL_CreateRenderer(this->help_window, -1, SDL_RENDERER_ACCELERATED);
 }
 
 void UIController::closeHelpWindow() {
+	UI::ResourceCache::instance().releaseRenderer(this->help_renderer); // cached textures belong to the help renderer
 	SDL_DestroyRenderer(this->help_renderer);
 	SDL_DestroyWindow(this->help_window);
 	this->help_renderer = nullptr;
@@ -326,18 +560,14 @@ void UIController::help_RenderText(const char* text, int x, int y) {
 	} // exit if text is empty
 
 	// rendering
-	auto font_path = UI::getExecutableDirectory() + "\\assets\\arial.ttf";
-	TTF_Font* font = TTF_OpenFont(font_path.c_str(), 14);
+	static const std::string font_path = UI::getExecutableDirectory() + "\\assets\\arial.ttf";
+	TTF_Font* font = UI::ResourceCache::instance().getFont(font_path, 14);
 	SDL_Color color = {220, 220, 220}; // text color
-	SDL_Surface* surface = TTF_RenderText_Blended(font, text, color);
-	SDL_Texture* texture = SDL_CreateTextureFromSurface(help_renderer, surface);
-	SDL_Rect dest_rect = {x, y, surface->w, surface->h}; // text size and position
-	SDL_RenderCopy(help_renderer, texture, nullptr, &dest_rect); // render
+	UI::TextTexture texture = UI::ResourceCache::instance().getText(help_renderer, font, text, color, UI::TextMode::Blended);
+	if (!texture.texture) return; // exit if text couldn't be rendered
 
-	// clean up
-	SDL_DestroyTexture(texture);
-	SDL_FreeSurface(surface);
-	TTF_CloseFont(font);
+	SDL_Rect dest_rect = {x, y, texture.width, texture.height}; // text size and position
+	SDL_RenderCopy(help_renderer, texture.texture, nullptr, &dest_rect); // render
 }
 
 void UIController::help_RenderContent() {
@@ -354,7 +584,12 @@ void UIController::help_RenderContent() {
 		{"Zoom in and out of the grid by moving your mouse's scrollwheel up and down", IconType::Scroll},
 		{"Increase and decrease your brush size by pressing ']' and '[' or moving the scroll wheel up and down while holding ctrl", IconType::Scroll},
 		{"Press the play button to run the simulation", IconType::Play},
-		{"Control the playback speed using the slider at the bottom of the side panel", IconType::Speed},
+		{"Right click the next button to step 1, 10, 100 or 1000 generations at a time", IconType::Right},
+		{"Press the left arrow key to step back one generation", IconType::Play},
+		{"Press 'c' to count the objects on the board, the census is shown and saved to census.csv", IconType::Cell},
+		{"Press 't' to start recording a trace, press it again to save it to trace.json and a summary to trace-summary.txt", IconType::Speed},
+		{"Press 'h' to show or hide the performance overlay in the side panel", IconType::Speed},
+		{"Control the playback speed using the slider at the bottom of the side panel, far right is max speed", IconType::Speed},
 		{"", IconType::None},  // Empty line
 		{"If a cell is alive and has fewer than 2 alive neighbors it'll die", IconType::Cell},
 		{"If a cell is alive and has 2 or 3 alive neighbors it'll live", IconType::Cell},
@@ -397,31 +632,15 @@ void UIController::help_RenderIcon(IconType type, int x, int y) {
 	} // exit if invalid icon or no icon
 
 
-	// icon loading
-	SDL_Surface* icon_surface = IMG_Load(icon_paths[static_cast<int>(type) - 1]);
-	if (!icon_surface) {
-		std::cerr << "ERROR: Couldn't load icon " << icon_paths[static_cast<int>(type) - 1]
-			<< " errormsg: " << IMG_GetError() << std::endl;
-		return;
-	} // handle error
-
-	// texture creation
-	SDL_Texture* icon_texture = SDL_CreateTextureFromSurface(help_renderer, icon_surface);
-	if (!icon_texture) {
-		std::cerr << "ERROR: Couldn't create texture, errormsg: " << SDL_GetError() << std::endl;
-		SDL_FreeSurface(icon_surface);
-		return;
-	} // handle error
+	// icon loading (cached per renderer)
+	SDL_Texture* icon_texture = UI::ResourceCache::instance().getIcon(help_renderer, icon_paths[static_cast<int>(type) - 1]);
+	if (!icon_texture) return; // exit if icon couldn't be loaded
 
 	// icon position and size
 	SDL_Rect dest_rect = {x, y, 20, 20};  // Adjust size as needed
 
 	// render
 	SDL_RenderCopy(help_renderer, icon_texture, NULL, &dest_rect);
-
-	// clean up
-	SDL_DestroyTexture(icon_texture);
-	SDL_FreeSurface(icon_surface);
 }
 #pragma endregion
 
@@ -433,6 +652,7 @@ void UIController::init(Universe* universe, int window_width, int window_height,
 	this->grid_view = grid_view;
 	this->panel_width = window_width / 4;
 	this->initializeUIComponents();
+	this->scheduler = new SimulationScheduler(universe, this->speed_slider->getValue());
 }
 
 void UIController::initializeUIComponents() {
@@ -457,24 +677,32 @@ void UIController::initializeButtons(int margin, float height, float button_widt
 	this->buttons.emplace_back(new UI::Button(x_first, 3 * margin + 2 * height, button_half_width, height, "Load", UI::Button::ID::Load));
 	this->buttons.emplace_back(new UI::Button(x_second, 3 * margin + 2 * height, button_half_width, height, "Export", UI::Button::ID::Export));
 	this->buttons.emplace_back(new UI::Button(x_first, 4 * margin + 3 * height, button_half_width, height, "Randomize", UI::Button::ID::Randomize));
-	this->buttons.emplace_back(new UI::Button(x_first, 5 * margin + 4 * height, button_width, height, "Help", UI::Button::ID::Help));
+	this->buttons.emplace_back(new UI::Button(x_first, 5 * margin + 4 * height, button_half_width, height, "Help", UI::Button::ID::Help));
 	this->buttons.emplace_back(new UI::Button(x_first, 8 * margin + 7 * height + 32.5, button_width, height, "Confirm", UI::Button::ID::Confirm));
 }
 
 void UIController::initializeTextBoxes(int margin, float height, float button_width, float button_half_width, float x_first, float x_second) {
 	auto font_path = UI::getExecutableDirectory() + "\\assets\\arialbd.ttf";
-	TTF_Font* font = TTF_OpenFont(font_path.c_str(), 14);
+	TTF_Font* font = UI::ResourceCache::instance().getFont(font_path, 14);
 	this->textboxes.emplace_back(new UI::NumericTextBox(x_first, 6 * margin + 5 * height + 15, button_width, height, 5, 1e5, this->universe->getWidth(), font, "Grid Width", UI::NumericTextBox::ID::Width));
 	this->textboxes.emplace_back(new UI::NumericTextBox( x_first, 7 * margin + 6 * height + 35, button_width, height, 5, 1e5, this->universe->getHeight(), font, "Grid Height", UI::NumericTextBox::ID::Height));
 	this->textboxes.emplace_back(new UI::NumericTextBox( x_second, 4 * margin + 3 * height + 27, button_half_width, height / 2, 0, 100, 20, font, "% alive", UI::NumericTextBox::ID::Percent));
 }
 
 void UIController::initializeSlider(int margin, float height, float button_width, float button_half_width, float x_first, float x_second) {
-	this->speed_slider = new UI::Slider(x_first, 9 * margin + 8.5 * height + 5, button_width, height / 2);
+	this->speed_slider = new UI::Slider(x_first, 9 * margin + 8.5 * height + 5, button_width, height / 2, 1, MAX_SPEED_VALUE);
+	this->readout_rect = SDL_Rect{static_cast<int>(x_second), static_cast<int>(5 * margin + 4 * height), static_cast<int>(button_half_width), static_cast<int>(height)};
+	this->hud_rect = SDL_Rect{static_cast<int>(x_first), static_cast<int>(6 * margin + 5 * height), static_cast<int>(button_width), static_cast<int>(2 * margin + 3 * height + 32.5)};
 }
 #pragma endregion
 
 #pragma region file dialog
+std::string UIController::choosePatternFile() {
+	std::string filename = this->convertWStringToString(this->openLoadFileDialog());
+	this->dialog_close_time = SDL_GetTicks(); // the click that closed the dialog mustn't reach the board
+	return filename;
+}
+
 std::wstring UIController::openLoadFileDialog() {
 	OPENFILENAME ofn;
 	wchar_t file[260] = {0}; // filename
@@ -484,7 +712,7 @@ std::wstring UIController::openLoadFileDialog() {
 	ofn.hwndOwner = nullptr; // no specific window owns the dialog
 	ofn.lpstrFile = file;  // store filename in file string
 	ofn.nMaxFile = sizeof(file) / sizeof(wchar_t);
-	ofn.lpstrFilter = L"Text Files\0*.TXT\0All Files\0*.*\0"; // file filter
+	ofn.lpstrFilter = L"Patterns\0*.TXT;*.CELLS;*.LIF;*.LIFE\0Text Files\0*.TXT\0Plaintext\0*.CELLS\0Life 1.06\0*.LIF;*.LIFE\0All Files\0*.*\0"; // file filter
 	ofn.nFilterIndex = 1;
 	ofn.Flags = OFN_PATHMUSTEXIST | OFN_FILEMUSTEXIST;
 
@@ -506,7 +734,7 @@ std::wstring UIController::openSaveFileDialog() {
 	ofn.lpstrFile = file_name; // store filename in file string
 	ofn.lpstrFile[0] = '\0';
 	ofn.nMaxFile = sizeof(file_name) / sizeof(wchar_t);
-	ofn.lpstrFilter = L"Text Files\0*.TXT\0All Files\0*.*\0"; // file filter
+	ofn.lpstrFilter = L"Text Files\0*.TXT\0Plaintext\0*.CELLS\0Life 1.06\0*.LIF\0"; // file filter, the extension picks the format
 	ofn.nFilterIndex = 1;
 	ofn.lpstrDefExt = L"txt";  
 	ofn.Flags = OFN_OVERWRITEPROMPT | OFN_PATHMUSTEXIST;  
@@ -515,9 +743,14 @@ std::wstring UIController::openSaveFileDialog() {
 	if (GetSaveFileName(&ofn) == TRUE) {
 		std::wstring file(file_name); // convert filename to wstring
 
-		if (file.find(L".txt") == std::wstring::npos) {
-			file += L".txt";
-		} // add .txt extension
+		const wchar_t* extensions[] = {L".txt", L".cells", L".lif"};
+		bool has_extension = false;
+		for (const wchar_t* extension : extensions) {
+			has_extension |= file.find(extension) != std::wstring::npos;
+		}
+		if (!has_extension) {
+			file += extensions[std::min<DWORD>(std::max<DWORD>(ofn.nFilterIndex, 1), 3) - 1];
+		} // add the chosen filter's extension
 
 		return file;
 	}
@@ -544,40 +777,12 @@ void UIController::lockDestructiveButtons(bool locked) {
 	}
 }
 
-void UIController::play() {
-	while (this->is_playing.load()) {
-		if (this->grid_resize_requested.load()) {
-			this->universe->setGridSize(this->requested_width, this->requested_height);
-			this->grid_resize_requested.store(false);
-		} // handle resizing events before playing
-
-		auto start_time = std::chrono::steady_clock::now(); // record cycle start time
-
-		this->universe->nextGeneration(); // proceed to next generation every cycle
-
-		std::this_thread::sleep_for(std::chrono::milliseconds(
-			static_cast<int>(1000 / this->generations_per_second))
-		); // delay time (depends on value of speed slider)
-
-		auto end_time = std::chrono::steady_clock::now(); // record cycle end time
-
-		auto elapsed_time = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count(); // measure time taken in cycle processing
-
-		if (elapsed_time < (1000 / this->generations_per_second)) {
-			std::this_thread::sleep_for(std::chrono::milliseconds(static_cast<int>((1000 / this->generations_per_second)) - elapsed_time));
-		} // sleep for remaining time
-	}
-}
-
 void UIController::handlePlayStopButton() {
-	if (this->is_playing.load()) {
-		this->is_playing.store(false);
+	if (this->scheduler->isRunning()) {
+		this->scheduler->stop();
+		this->scheduler->join(); // wait for the current generation so edits after stopping don't race it
 	} else {
-		this->is_playing.store(true); 
-		std::thread play_thread([this]() {
-			this->play();
-		}); // create a separate thread to run the play method in parallel with the main game thread
-		play_thread.detach(); // detach the thread to run independently
+		this->scheduler->start(); // run generations on the scheduler's thread in parallel with the main game thread
 	}
 }
 #pragma endregion
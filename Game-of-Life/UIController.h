@@ -1,29 +1,52 @@
 #pragma once
 #include <string>
 #include <vector>
-#include <thread>
-#include <atomic>
-#include <chrono>
 #include <SDL_image.h>
 #include "GridView.h"
+#include "SimulationScheduler.h"
+#include "Profiler.h"
 
 class UIController {
 public:
 	UIController(Universe* universe, int window_width, int window_height, GridView* grid_view);
+	~UIController();
 
 #pragma region Rendering & UI
 public:
 	// ---- methods ----
 	void render(SDL_Renderer* renderer);
+	void update(); // per-frame work that isn't input or rendering
+	void toggleHud(); // performance overlay over the lower part of the panel
+	bool isHudVisible() const;
+	void showMessage(const std::vector<std::string>& lines); // shown over the bottom of the board for a few seconds, the app has no console to print to
 
 private:
+	// ---- methods ----
+	void renderSpeedReadout(SDL_Renderer* renderer);
+	void updateSpeedReadout();
+	void renderHud(SDL_Renderer* renderer);
+	void renderMessage(SDL_Renderer* renderer);
+	void updateHud();
+	std::string formatCount(double value);
+	std::string formatBytes(double bytes);
+	std::string formatMilliseconds(double ms);
+
 	// ---- attributes ----
 	GridView* grid_view;
 	Universe* universe;
 	std::vector<UI::Button*> buttons; // start, next, load, export, recenter, help
 	UI::Slider* speed_slider;
 	std::vector<UI::NumericTextBox*> textboxes;
-
+	SDL_Rect readout_rect; // generations/sec and cells/sec readout next to the help button
+	std::vector<std::string> readout_lines;
+	uint32_t last_readout_update = 0;
+	SDL_Rect hud_rect; // covers the grid size controls while visible
+	std::vector<std::string> hud_lines;
+	uint32_t last_hud_update = 0;
+	bool hud_visible = false;
+	std::vector<std::string> message_lines;
+	uint32_t message_time = 0; // when the message was shown
+	Profiler::Clock::time_point last_frame;
 
 	int panel_width;
 	int window_width;
@@ -35,10 +58,12 @@ public:
 	// ---- methods ----
 	void handleInput(const SDL_Event& event);
 	bool isInsidePanel(int mouse_x, int mouse_y);
+	int getRandomPercent(); // value of the randomize percentage textbox
 
 private:
 	void handleButtonInputs(const SDL_Event& event, int mouse_x, int mouse_y, uint32_t current_time, double elapsed_time);
 	void handleButtonAction(UI::Button* button);
+	void cycleNextStepCount(UI::Button* button);
 	void handleTextBoxInputs(const SDL_Event& event, int mouse_x, int mouse_y, uint32_t current_time, double elapsed_time);
 	void handleTextBoxFocus(const SDL_Event& event, int mouse_x, int mouse_y, UI::NumericTextBox* textbox, double elapsed_time);
 	void handleTextBoxUnfocus(UI::NumericTextBox* textbox);
@@ -49,10 +74,13 @@ private:
 	void handleSliderInputs(const SDL_Event& event, int mouse_x, int mouse_y);
 	void updateSliderKnobColor(int mouse_x, int mouse_y);
 	void handleSliderDrag(const SDL_Event& event, int mouse_x, int mouse_y);
+	void applySpeedSliderValue();
 
 	// ---- attributes ----
 	double action_time = 0.5;
 	uint32_t last_button_press = 0;
+	size_t next_step_index = 0; // into NEXT_STEP_COUNTS
+	static constexpr uint64_t NEXT_STEP_COUNTS[] = {1, 10, 100, 1000};
 	bool ignore_next_event = false;
 #pragma endregion
 
@@ -96,6 +124,10 @@ private:
 #pragma endregion
 
 #pragma region file dialog
+public:
+	// ---- methods ----
+	std::string choosePatternFile(); // load dialog for a pattern to paste, empty if cancelled
+
 private:
 	// ---- methods ----
 	std::wstring openLoadFileDialog();
@@ -112,16 +144,13 @@ private:
 private:
 	// ---- methods ----
 	void lockDestructiveButtons(bool locked);
-	void play();
 	void handlePlayStopButton();
 
 	// ---- attributes ----
-	double generations_per_second = 5.0f;
-	std::atomic<bool> is_playing = false;
-
-	std::atomic<bool> grid_resize_requested{false};
-	int requested_width{0};
-	int requested_height{0};
+	SimulationScheduler* scheduler;
+	static constexpr int MAX_SPEED_VALUE = 51; // last notch of the speed slider runs uncapped
+	static constexpr uint32_t READOUT_INTERVAL = 250; // ms between readout refreshes
+	static constexpr uint32_t MESSAGE_DURATION = 6000; // ms a message stays on screen
 
 #pragma endregion
 };
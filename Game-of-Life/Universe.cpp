@@ -1,147 +1,412 @@
 #include "Universe.h"
+#include "Profiler.h"
+#include "GridArena.h"
 #include <fstream>
 #include <random>
 #include <ctime>
 #include <iostream>
+#include <limits>
+#include <filesystem>
 
 Universe::Universe(int width, int height, int percent) {
 	this->initialize(width, height, percent);
 }
 
 void Universe::reset() {
-	// set all cells to dead
-	for (int i = 0; i < this->getHeight(); i++) {
-		for (int j = 0; j < this->getWidth(); j++) {
-			this->simulation_grid[i][j] = CellState::Dead;
-		}
+	std::lock_guard<std::mutex> lock(this->grid_mutex);
+
+	this->simulation_grid.clear(); // set all cells to dead
+	this->restartTimelineLocked();
+	this->publishLocked(); // sync rendering grid
+}
+
+void Universe::nextGeneration(bool publish) {
+	PROFILE_SCOPE("Universe::nextGeneration");
+	std::unique_lock<std::mutex> lock = Profiler::instance().lockTimed(this->grid_mutex, "grid_mutex wait");
+
+	this->applyEditsLocked(false); // apply edits made since the last generation, publishing below covers the rendering grid
+	this->stepLocked();
+
+	// Update the rendering grid to reflect the new state
+	if (publish) {
+		this->publishLocked();
 	}
-	this->rendering_grid = this->simulation_grid; // sync rendering grid
 }
 
-int Universe::countNeighbors(int cell_x, int cell_y) {
-	int count = 0;
+uint64_t Universe::advance(uint64_t generations, bool stop_on_cycle) {
+	PROFILE_SCOPE("Universe::advance");
+	std::unique_lock<std::mutex> lock = Profiler::instance().lockTimed(this->grid_mutex, "grid_mutex wait");
+
+	this->applyEditsLocked(false); // apply edits made since the last generation, publishing below covers the rendering grid
+
+	uint64_t stepped = 0;
+	while (stepped < generations) {
+		this->stepLocked();
+		stepped++;
+
+		if (stop_on_cycle && this->cycle_detector.getResult().found) break;
+	} // the two grids swap roles every generation, nothing is allocated or copied
 
-	for (int i = cell_y - 1; i <= cell_y + 1; i++) {
-		for (int j = cell_x - 1; j <= cell_x + 1; j++) {
-			if (i == cell_y && j == cell_x) {
-				continue;
-			} // skip if current cell
+	this->publishLocked(); // the renderer only needs the final generation
+	return stepped;
+}
 
-			if (i < 0 || i >= this->getHeight() || j < 0 || j >= this->getWidth()) {
-				continue;
-			} // skip if out of bounds
+void Universe::stepLocked() {
+	if (this->recordsHistoryLocked() && (this->history.empty() || this->history.getNewestGeneration() != this->generation || this->history_edited)) {
+		this->recordHistoryLocked();
+	} // keep the starting state so the first step can be undone
 
-			if (this->simulation_grid[i][j] == CellState::Alive) {
-				count++;
-			} // count if in bounds
+	// build the next generation in the step buffer, it keeps its memory between generations
+	if (this->step_buffer.getWidth() != this->getWidth() || this->step_buffer.getHeight() != this->getHeight()) {
+		this->allocateGridLocked(this->step_buffer, this->getWidth(), this->getHeight());
+	}
+	int words = this->simulation_grid.getWordsPerRow();
+	if (this->zero_row.size() < static_cast<size_t>(words)) {
+		this->zero_row.assign(words, 0);
+	}
+	GenerationStats stats; // gathered while stepping so there's no extra pass
+
+	Profiler::Clock::time_point step_start = Profiler::Clock::now();
+	bool parallel = this->stepper.getThreadCount() > 1 && static_cast<int64_t>(this->getWidth()) * this->getHeight() >= PARALLEL_STEP_CELLS;
+	if (parallel || this->simulation_grid.isFileBacked()) {
+		this->stepper.step(this->simulation_grid, this->step_buffer, 1, stats); // tiles spread over the stepper's workers, the result lands in simulation_grid; settled tiles are skipped, so a file-backed board only dirties pages near activity
+	} else {
+		uint64_t last_mask = this->simulation_grid.getLastWordMask();
+		for (int i = 0; i < this->getHeight(); i++) {
+			const uint64_t* above = i > 0 ? this->simulation_grid.row(i - 1) : this->zero_row.data();
+			const uint64_t* below = i + 1 < this->getHeight() ? this->simulation_grid.row(i + 1) : this->zero_row.data();
+			BitGrid::stepRow(above, this->simulation_grid.row(i), below, this->step_buffer.row(i), words, last_mask); // 64 cells at a time
+			TileStepper::accumulateRow(i, 0, this->simulation_grid.row(i), this->step_buffer.row(i), words, stats); // row is still in cache
 		}
+
+		// replace old simulation_grid with new simulation_grid
+		std::swap(this->simulation_grid, this->step_buffer);
+		this->stepper.invalidate(); // the step buffer no longer holds what the stepper left there
 	}
+	if (Profiler::isEnabled()) {
+		Profiler::instance().record("step", step_start, Profiler::Clock::now());
+	} // step time without the bookkeeping around it
 
-	return count;
+	this->finishStepLocked(stats, 1);
 }
 
-void Universe::nextGeneration() {
-	std::lock_guard<std::mutex> lock(this->grid_mutex);
+void Universe::step(uint64_t generations, bool publish) {
+	PROFILE_SCOPE("Universe::step");
+	std::unique_lock<std::mutex> lock = Profiler::instance().lockTimed(this->grid_mutex, "grid_mutex wait");
 
-	// create a temporary simulation_grid to store the next generation
-	Grid next_grid(this->getHeight(), std::vector<CellState>(this->getWidth(), CellState::Dead));
+	this->applyEditsLocked(false); // apply edits made since the last generation, publishing below covers the rendering grid
+	if (generations == 0) return;
 
-	for (int i = 0; i < this->getHeight(); i++) {
-		for (int j = 0; j < this->getWidth(); j++) {
-			int neighbors = this->countNeighbors(j, i);
-			if (this->simulation_grid[i][j] == CellState::Alive) {
-				if (neighbors < 2 || neighbors > 3) {
-					next_grid[i][j] = CellState::Dead; // if cell is alive and has less than 2 or more than 3 alive neighbors, it'll become dead
-				} else {
-					next_grid[i][j] = CellState::Alive; // if cell is alive and has exactly 2 or 3 alive neighbors, it'll remain alive
-				}
-			} else {
-				if (neighbors == 3) {
-					next_grid[i][j] = CellState::Alive; // if cell is dead and has exactly 3 alive neighbors, it'll become alive
-				}
-			}
-		}
-	}
+	if (this->recordsHistoryLocked() && (this->history.empty() || this->history.getNewestGeneration() != this->generation || this->history_edited)) {
+		this->recordHistoryLocked();
+	} // keep the starting state so the steps can be undone
 
-	// replace old simulation_grid with new simulation_grid
-	this->simulation_grid = std::move(next_grid);
+	GenerationStats stats;
+	this->stepper.step(this->simulation_grid, this->step_buffer, generations, stats); // identical to calling nextGeneration generations times
+	this->finishStepLocked(stats, generations);
 
 	// Update the rendering grid to reflect the new state
-	this->rendering_grid = this->simulation_grid;
+	if (publish) {
+		this->publishLocked();
+	}
+}
+
+void Universe::finishStepLocked(GenerationStats& stats, uint64_t generations) {
+	this->generation += generations;
+
+	if (this->recordsHistoryLocked()) {
+		this->recordHistoryLocked(); // a jump over several generations starts a new history timeline
+	}
+
+	this->grid_hash = stats.hash;
+	stats.generation = this->generation;
+	if (generations > 1) {
+		this->cycle_detector.clear();
+	} // skipped generations can't be compared, only cycles from here on can be found
+	this->cycle_detector.update(stats.generation, stats.hash, stats.population);
+	this->publishStatsLocked(stats, true);
+	this->publishMemoryUsageLocked(); // the history and tile buffers change with every step
+	Profiler::instance().counter("population", static_cast<double>(stats.population));
 }
 
 void Universe::setCellState(int cell_x, int cell_y, CellState state) {
 	{
 		std::lock_guard<std::mutex> lock(this->grid_mutex);
-		this->simulation_grid[cell_y][cell_x] = state;
-		this->rendering_grid[cell_y][cell_x] = state; // sync rendering grid
+		if (this->setCellLocked(cell_x, cell_y, state == CellState::Alive)) {
+			this->clearCycleLocked(); // an edit breaks any cycle seen so far
+			this->history_edited = true;
+		}
+
+		this->syncRenderingLocked([&](BitGrid& grid) {
+			grid.setAlive(cell_x, cell_y, state == CellState::Alive);
+		}); // sync rendering grid
+	}
+}
+
+bool Universe::setCellLocked(int cell_x, int cell_y, bool alive) {
+	if (this->simulation_grid.isAlive(cell_x, cell_y) == alive) return false;
+
+	uint64_t& word = this->simulation_grid.row(cell_y)[cell_x / 64];
+	uint64_t before = word;
+	this->simulation_grid.setAlive(cell_x, cell_y, alive);
+	this->stepper.markChanged(cell_x, cell_y);
+	this->grid_hash ^= BitGrid::wordHash(cell_y, cell_x / 64, before) ^ BitGrid::wordHash(cell_y, cell_x / 64, word); // swap the word's old contribution for its new one
+	return true;
+}
+
+void Universe::submitEdit(EditBatch batch) {
+	if (batch.cells.empty()) return; // nothing to apply
+	this->pending_edits.push(std::move(batch));
+}
+
+void Universe::applyPendingEdits() {
+	if (this->pending_edits.empty()) return; // avoid locking when there's nothing to do
+
+	std::unique_lock<std::mutex> lock = Profiler::instance().lockTimed(this->grid_mutex, "grid_mutex wait");
+	this->applyEditsLocked(true);
+}
+
+bool Universe::editRegionLocked(int x, int y, int width, int height, const std::function<uint64_t(int, int, uint64_t, uint64_t)>& edit) {
+	int64_t left = std::max<int64_t>(x, 0), right = std::min<int64_t>(int64_t(x) + width, this->getWidth()); // columns covered, exclusive end
+	int64_t top = std::max<int64_t>(y, 0), bottom = std::min<int64_t>(int64_t(y) + height, this->getHeight());
+	if (left >= right || top >= bottom) return false; // entirely off the board
+
+	int first_word = static_cast<int>(left / 64), last_word = static_cast<int>((right - 1) / 64);
+	uint64_t first_mask = ~uint64_t(0) << (left % 64);
+	uint64_t last_mask = (right % 64) ? (~uint64_t(0) >> (64 - right % 64)) : ~uint64_t(0);
+
+	bool changed = false;
+	for (int row = static_cast<int>(top); row < bottom; row++) {
+		uint64_t* words = this->simulation_grid.row(row);
+		for (int k = first_word; k <= last_word; k++) {
+			uint64_t mask = (k == first_word ? first_mask : ~uint64_t(0)) & (k == last_word ? last_mask : ~uint64_t(0));
+			uint64_t before = words[k];
+			words[k] = edit(row, k, before, mask);
+
+			if (words[k] != before) {
+				this->grid_hash ^= BitGrid::wordHash(row, k, before) ^ BitGrid::wordHash(row, k, words[k]); // swap the word's old contribution for its new one
+				this->stepper.markChanged(64 * k, row);
+				changed = true;
+			}
+		}
+	}
+
+	if (!changed) return false;
+	this->clearCycleLocked(); // an edit breaks any cycle seen so far
+	this->history_edited = true;
+
+	this->syncRenderingLocked([&](BitGrid& grid) {
+		if (grid.getWidth() != this->getWidth() || grid.getHeight() != this->getHeight()) return;
+		for (int row = static_cast<int>(top); row < bottom; row++) {
+			std::copy(this->simulation_grid.row(row) + first_word, this->simulation_grid.row(row) + last_word + 1, grid.row(row) + first_word);
+		}
+	}); // show the edit immediately while paused
+	return true;
+}
+
+void Universe::applyEditsLocked(bool sync_rendering) {
+	if (this->pending_edits.empty()) return;
+
+	std::vector<EditBatch> batches = this->pending_edits.drain();
+	int width = this->getWidth(), height = this->getHeight();
+
+	bool changed = false;
+	for (auto& batch : batches) {
+		for (auto& edit : batch.cells) {
+			if (edit.x < 0 || edit.x >= width || edit.y < 0 || edit.y >= height) continue; // grid may have been resized since the edit was queued
+			changed |= this->setCellLocked(edit.x, edit.y, edit.state == CellState::Alive);
+		}
+	}
+
+	if (changed) {
+		this->clearCycleLocked();
+		this->history_edited = true;
+	} // an edit breaks any cycle seen so far
+
+	if (sync_rendering) {
+		this->syncRenderingLocked([&](BitGrid& grid) {
+			for (auto& batch : batches) {
+				for (auto& edit : batch.cells) {
+					if (edit.x < 0 || edit.x >= grid.getWidth() || edit.y < 0 || edit.y >= grid.getHeight()) continue;
+					grid.setAlive(edit.x, edit.y, edit.state == CellState::Alive);
+				}
+			}
+		});
+	} // show edits immediately while paused
+}
+
+bool Universe::stamp(const Stamp& pattern, int x, int y, StampMode mode) {
+	PROFILE_SCOPE("Universe::stamp");
+	std::unique_lock<std::mutex> lock = Profiler::instance().lockTimed(this->grid_mutex, "grid_mutex wait");
+	this->applyEditsLocked(true); // brush edits made before the stamp go first
+
+	const BitGrid& cells = pattern.getCells();
+	return this->editRegionLocked(x, y, cells.getWidth(), cells.getHeight(), [&](int row, int word_index, uint64_t word, uint64_t mask) {
+		uint64_t bits = BitGrid::getBits(cells.row(row - y), cells.getWordsPerRow(), int64_t(64) * word_index - x) & mask; // the pattern's cells lined up with this word
+		switch (mode) {
+		case StampMode::Or: return word | bits;
+		case StampMode::Xor: return word ^ bits;
+		case StampMode::Replace: return (word & ~mask) | bits;
+		}
+		return word;
+	});
+}
+
+Stamp Universe::copyRegion(int x, int y, int width, int height) {
+	std::unique_lock<std::mutex> lock = Profiler::instance().lockTimed(this->grid_mutex, "grid_mutex wait");
+	this->applyEditsLocked(true); // include what was just drawn
+
+	int left = std::max(x, 0), top = std::max(y, 0);
+	int right = static_cast<int>(std::min<int64_t>(int64_t(x) + width, this->getWidth()));
+	int bottom = static_cast<int>(std::min<int64_t>(int64_t(y) + height, this->getHeight()));
+	if (left >= right || top >= bottom || !Stamp::fitsBytes(right - left, bottom - top, this->getMemoryBudget())) {
+		return Stamp();
+	} // nothing on the board, or too large to hold next to it
+
+	BitGrid cells(right - left, bottom - top);
+	for (int row = 0; row < cells.getHeight(); row++) {
+		const uint64_t* source = this->simulation_grid.row(top + row);
+		uint64_t* target = cells.row(row);
+		for (int k = 0; k < cells.getWordsPerRow(); k++) {
+			target[k] = BitGrid::getBits(source, this->simulation_grid.getWordsPerRow(), left + int64_t(64) * k);
+		}
+		target[cells.getWordsPerRow() - 1] &= cells.getLastWordMask(); // columns past the copy's right edge
 	}
+	return Stamp(std::move(cells));
+}
+
+bool Universe::clearRegion(int x, int y, int width, int height) {
+	std::unique_lock<std::mutex> lock = Profiler::instance().lockTimed(this->grid_mutex, "grid_mutex wait");
+	this->applyEditsLocked(true);
+
+	return this->editRegionLocked(x, y, width, height, [](int, int, uint64_t word, uint64_t mask) {
+		return word & ~mask;
+	});
+}
+
+bool Universe::invertRegion(int x, int y, int width, int height) {
+	std::unique_lock<std::mutex> lock = Profiler::instance().lockTimed(this->grid_mutex, "grid_mutex wait");
+	this->applyEditsLocked(true);
+
+	return this->editRegionLocked(x, y, width, height, [](int, int, uint64_t word, uint64_t mask) {
+		return word ^ mask;
+	});
+}
+
+bool Universe::randomizeRegion(int x, int y, int width, int height, int percent, unsigned int seed) {
+	std::unique_lock<std::mutex> lock = Profiler::instance().lockTimed(this->grid_mutex, "grid_mutex wait");
+	this->applyEditsLocked(true);
+
+	// each bit of a word is alive with probability percent / 100, to 16 bits of precision:
+	// going from the lowest bit of the probability up, a 1 ors in a random word and a 0 ands one in
+	uint32_t probability = static_cast<uint32_t>(std::clamp(percent, 0, 100) * 65536 / 100);
+	std::mt19937_64 rng(seed); // the same seed always gives the same cells
+	return this->editRegionLocked(x, y, width, height, [&](int, int, uint64_t word, uint64_t mask) {
+		uint64_t random = probability >= 65536 ? ~uint64_t(0) : 0;
+		for (int bit = 0; bit < 16 && probability < 65536; bit++) {
+			random = ((probability >> bit) & 1) ? (random | rng()) : (random & rng());
+		}
+		return (word & ~mask) | (random & mask);
+	});
 }
 
 CellState Universe::getCellState(int cell_x, int cell_y) const {
 	std::lock_guard<std::mutex> lock(grid_mutex); // lock simulation_grid mutex for thread safety
 
-	if (cell_x >= 0 && cell_x < this->getWidth() && cell_y >= 0 && cell_y <= this->getHeight()) {
-		return this->simulation_grid[cell_y][cell_x];
+	if (cell_x >= 0 && cell_x < this->getWidth() && cell_y >= 0 && cell_y < this->getHeight()) {
+		return this->simulation_grid.isAlive(cell_x, cell_y) ? CellState::Alive : CellState::Dead;
 	} // if requested cell is in bounds return its state
 
 	return CellState::Dead; // return dead if out of bounds
 }
 
 int Universe::getWidth() const {
-	if (this->simulation_grid.empty()) return 0; // return 0 if simulation_grid is empty
-	return this->simulation_grid.front().size();
+	return this->simulation_grid.getWidth();
 }
 
 int Universe::getHeight() const {
-	return this->simulation_grid.size();
+	return this->simulation_grid.getHeight();
 }
 
-void Universe::loadFromFile(std::string& filename) {
-	std::ifstream file(filename);
+bool Universe::loadFromFile(std::string& filename) {
+	PROFILE_SCOPE("Universe::loadFromFile");
+	std::ifstream file(filename, std::ios::binary);
 	if (!file.is_open()) {
 		std::cout << "ERROR: Couldn't load from file" << std::endl;
-		return;
+		return false;
 	} // exit if couldn't open file
 
+	return this->loadFromStream(file, PatternFile::detectFormat(filename, file));
+}
+
+bool Universe::loadFromStream(std::istream& input, PatternFile::Format format) {
+	if (format != PatternFile::Format::Dense) {
+		SparsePattern pattern;
+		size_t max_cells = this->getMemoryBudget() / sizeof(pattern.cells[0]); // the cell list mustn't outgrow the budget either
+		bool read = format == PatternFile::Format::Cells ? PatternFile::readCells(input, pattern, max_cells) : PatternFile::readLife106(input, pattern, max_cells);
+		return read && this->loadPattern(pattern);
+	} // the sparse formats only list live cells
+
 	int read_width = 0, read_height = 0;
-	if (!(file >> read_width >> read_height)) {
-		std::cout << "ERROR: Couldn't read width and height" << std::endl;
-		return;
-	} // exit if now width or height
+	if (!PatternFile::readDenseSize(input, read_width, read_height)) {
+		return false;
+	} // exit if no valid width or height
 
-	int width = std::clamp(read_width, 5, 100000); // clamp width to 5-100000
-	int height = std::clamp(read_height, 5, 10000000 / width); // clamp height to 5-10000000/width
-	
-	// skip newline after reading width and height
-	file.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+	int width = std::max(read_width, 5); // at least 5x5
+	int height = std::max(read_height, 5);
+	if (!this->checkMemoryBudget(width, height)) {
+		return false;
+	} // exit before allocating a board that doesn't fit
 
 	// temporary simulation_grid to store file data
-	Grid temp_grid(height, std::vector<CellState>(width, CellState::Dead));
-	
-	std::string current_line;
-	int row = 0; // current row
-	
-	while (row < std::min(read_height, height) && std::getline(file, current_line)) {
-		if (current_line.empty()) continue; // skip empty lines
+	BitGrid temp_grid;
+	{
+		std::lock_guard<std::mutex> lock(this->grid_mutex);
+		this->allocateGridLocked(temp_grid, width, height);
+	}
+	PatternFile::readDenseRows(input, temp_grid, read_width, read_height);
 
-		for (int col = 0; col < std::min({static_cast<int>(current_line.length()), width, read_width}); col++) {
-			temp_grid[row][col] = (current_line[col] == '1') ? CellState::Alive : CellState::Dead;
-		} // set cell state
+	{
+		std::lock_guard<std::mutex> lock(this->grid_mutex);
 
-		row++; // move to next row
+		// set simulation_grid to new simulation_grid
+		this->simulation_grid = std::move(temp_grid);
+		this->restartTimelineLocked();
+		this->publishLocked(); // sync rendering grid
 	}
+	return true;
+}
+
+bool Universe::loadPattern(const SparsePattern& pattern) {
+	int width = std::max(pattern.width, 5); // at least 5x5
+	int height = std::max(pattern.height, 5);
+	if (!this->checkMemoryBudget(width, height)) {
+		return false;
+	} // exit before allocating a board that doesn't fit
 
+	BitGrid temp_grid;
 	{
 		std::lock_guard<std::mutex> lock(this->grid_mutex);
+		this->allocateGridLocked(temp_grid, width, height);
+	}
 
-		// set simulation_grid to new simulation_grid
+	for (const std::pair<int, int>& cell : pattern.cells) {
+		if (cell.first >= 0 && cell.first < width && cell.second >= 0 && cell.second < height) {
+			temp_grid.setAlive(cell.first, cell.second, true);
+		}
+	} // only the live cells are written, the rest of the board is already dead
+
+	{
+		std::lock_guard<std::mutex> lock(this->grid_mutex);
 		this->simulation_grid = std::move(temp_grid);
-		this->rendering_grid = this->simulation_grid; // sync rendering grid
+		this->restartTimelineLocked();
+		this->publishLocked(); // sync rendering grid
 	}
+	return true;
 }
 
 void Universe::exportToFile(std::string& filename) {
+	PROFILE_SCOPE("Universe::exportToFile");
 	std::ofstream file(filename);
 
 	if (!file.is_open()) {
@@ -149,12 +414,23 @@ void Universe::exportToFile(std::string& filename) {
 		return;
 	} // exit if couldn't open file
 
+	PatternFile::Format format = PatternFile::getFormatOfFilename(filename);
+	if (format != PatternFile::Format::Dense) {
+		std::string name = filename.substr(filename.find_last_of("/\\") + 1);
+		name = name.substr(0, name.find_last_of('.'));
+
+		std::lock_guard<std::mutex> lock(this->grid_mutex);
+		if (format == PatternFile::Format::Cells) PatternFile::writeCells(file, this->simulation_grid, name);
+		else PatternFile::writeLife106(file, this->simulation_grid);
+		return;
+	} // the sparse formats only visit words with live cells
+
 	file << this->getWidth() << " " << this->getHeight() << std::endl; // write width and height
 
 	// write cell states
 	for (int i = 0; i < this->getHeight(); i++) {
 		for (int j = 0; j < this->getWidth(); j++) {
-			if (this->simulation_grid[i][j] == CellState::Alive) {
+			if (this->simulation_grid.isAlive(j, i)) {
 				file << 1;
 			} else {
 				file << 0;
@@ -165,67 +441,80 @@ void Universe::exportToFile(std::string& filename) {
 }
 
 void Universe::display() {
-	for (auto row : this->simulation_grid) {
-		for (auto cell : row) {
-			std::cout << (cell == CellState::Alive ? "1" : "0") << ' ';
+	for (int i = 0; i < this->getHeight(); i++) {
+		for (int j = 0; j < this->getWidth(); j++) {
+			std::cout << (this->simulation_grid.isAlive(j, i) ? "1" : "0") << ' ';
 		}
 		std::cout << std::endl;
 	}
 }
 
-void Universe::setGridSize(int width, int height) {
+bool Universe::setGridSize(int width, int height) {
 	if (width <= 0 || height <= 0) {
 		std::cerr << "ERROR: Invalid grid size: width = " << width << ", height = " << height << std::endl;
-		return;
+		return false;
 	} // exit if width or height is less than or equal to 0 
 
-	try {
-		auto copy = this->createEmptyGrid(width, height);
+	if (!this->checkMemoryBudget(width, height)) {
+		return false;
+	} // exit before allocating a board that doesn't fit
 
-		int copy_height = std::min(this->getHeight(), height);
-		int copy_width = std::min(this->getWidth(), width);
+	try {
+		BitGrid copy;
 
 		{
 			std::lock_guard<std::mutex> lock(this->grid_mutex);
 
-			// copy old simulation_grid to the new grid
-			for (int i = 0; i < copy_height; i++) {
-				for (int j = 0; j < copy_width; j++) {
-					copy[i][j] = this->simulation_grid[i][j];
-				}
-			}
+			this->allocateGridLocked(copy, width, height);
+			copy.copyOverlap(this->simulation_grid); // copy old simulation_grid to the new grid
 
 			this->simulation_grid = std::move(copy); // update grid size
-			this->rendering_grid = this->simulation_grid; // sync rendering grid
+			this->restartTimelineLocked();
+			this->publishLocked(); // sync rendering grid
 		}
 	} catch (const std::exception& e) {
 		std::cout << "ERROR: Exception during grid resize: " << e.what() << std::endl;
+		return false;
 	} catch (...) {
 		std::cout << "ERROR: Unknown exception during grid resize" << std::endl;
+		return false;
 	}
+	return true;
 }
 
-void Universe::initialize(int width, int height, int percent) {
-	Grid grid = this->createEmptyGrid(width, height); // create empty simulation_grid
+bool Universe::initialize(int width, int height, int percent) {
+	return this->initialize(width, height, percent, static_cast<unsigned int>(std::time(nullptr))); // seed based on time
+}
+
+bool Universe::initialize(int width, int height, int percent, unsigned int seed) {
+	if (!this->checkMemoryBudget(width, height)) {
+		return false;
+	} // exit before allocating a board that doesn't fit
+
+	BitGrid grid; // create empty simulation_grid
+	{
+		std::lock_guard<std::mutex> lock(this->grid_mutex);
+		this->allocateGridLocked(grid, width, height);
+	}
 
-	int total_cells = width * height; // total number of cells
-	int num_alive = static_cast<int>(total_cells * (percent / 100.0f)); // number of alive cells
+	int64_t total_cells = static_cast<int64_t>(width) * height; // total number of cells
+	int64_t num_alive = static_cast<int64_t>(total_cells * (percent / 100.0)); // number of alive cells
 
-	std::mt19937 rng(static_cast<unsigned int>(std::time(nullptr))); // get random number based on time
+	std::mt19937 rng(seed); // the same seed always gives the same board
 	std::uniform_int_distribution<int> dist_x(0, width - 1); // get random x coordinate between 0 and width
 	std::uniform_int_distribution<int> dist_y(0, height - 1); // get random y coordinate between 0 and height
 
-	auto placeRandomAlive = [&](int count) {
-		for (int i = 0; i < count; i++) {
+	auto placeRandomAlive = [&](int64_t count) {
+		for (int64_t i = 0; i < count; i++) {
 			int x = dist_x(rng); // get random x coordinate based on a random number
 			int y = dist_y(rng); // get random y coordinate based on a random number
 
-			while (grid[y][x] == CellState::Alive) {
+			while (grid.isAlive(x, y)) {
 				x = dist_x(rng);
 				y = dist_y(rng);
 			} // if cell is already alive, get new random coordinates
 			
-			grid[y][x] = CellState::Alive; // set cell to alive
+			grid.setAlive(x, y, true); // set cell to alive
 		}
 	}; // function to place a number of alive cells randomly on the simulation_grid
 
@@ -234,16 +523,284 @@ void Universe::initialize(int width, int height, int percent) {
 	{
 		std::lock_guard<std::mutex> lock(this->grid_mutex);
 		this->simulation_grid = std::move(grid); // set the simulation grid
-		this->rendering_grid = this->simulation_grid; // sync rendering grid
+		this->restartTimelineLocked();
+		this->publishLocked(); // sync rendering grid
 	}
+	return true;
 }
 
-const Grid& Universe::getRenderingGrid() {
+void Universe::publish() {
 	std::lock_guard<std::mutex> lock(this->grid_mutex);
-	return this->rendering_grid;;
+	this->publishLocked();
 }
 
-Grid Universe::createEmptyGrid(int width, int height) {
-	Grid grid(height, std::vector<CellState>(width, CellState::Dead));
-	return grid;
+void Universe::readRenderingGrid(const std::function<void(const BitGrid&)>& reader) {
+	std::unique_lock<std::mutex> lock = Profiler::instance().lockTimed(this->rendering_mutex, "rendering_mutex wait");
+	{
+		std::unique_lock<std::mutex> publish_lock(this->publish_mutex, std::try_to_lock);
+		if (publish_lock.owns_lock() && this->publish_pending) {
+			std::swap(this->rendering_grid, this->publish_buffer);
+			this->publish_pending = false;
+		}
+	} // take the frame published while the last one was being drawn, unless the next one is being copied right now
+	reader(this->rendering_grid);
+}
+
+void Universe::copyPackedGrid(std::vector<uint64_t>& packed, int& width, int& height) const {
+	std::lock_guard<std::mutex> lock(this->grid_mutex);
+	width = this->getWidth();
+	height = this->getHeight();
+	int words = this->simulation_grid.getWordsPerRow();
+	packed.resize(static_cast<size_t>(height) * words);
+	for (int i = 0; i < height; i++) {
+		std::copy(this->simulation_grid.row(i), this->simulation_grid.row(i) + words, packed.begin() + static_cast<size_t>(i) * words);
+	} // drop the padding that aligns the grid's rows
+}
+
+void Universe::publishLocked() {
+	PROFILE_SCOPE("Universe::publish");
+	std::lock_guard<std::mutex> publish_lock(this->publish_mutex); // the renderer only try_locks this, it never waits on the copy
+	if (this->simulation_grid.isFileBacked()) {
+		this->publish_buffer = BitGrid();
+	} else {
+		this->publish_buffer = this->simulation_grid; // copy outside the rendering lock, reuses the buffer's memory
+	} // a board that only fits on disk isn't shown, any copy would read every page of it while grid_mutex is held
+
+	this->publishMemoryUsageLocked();
+
+	std::unique_lock<std::mutex> lock(this->rendering_mutex, std::try_to_lock);
+	if (!lock.owns_lock()) {
+		this->publish_pending = true;
+		this->publish_buffer_bytes.store(this->publish_buffer.getMemoryUsage(), std::memory_order_relaxed);
+		return;
+	} // the renderer is drawing, it swaps this frame in before the next one instead of stepping waiting for it
+
+	std::swap(this->rendering_grid, this->publish_buffer);
+	this->publish_pending = false;
+	this->publish_buffer_bytes.store(this->publish_buffer.getMemoryUsage(), std::memory_order_relaxed);
+	this->rendering_grid_bytes.store(this->rendering_grid.getMemoryUsage(), std::memory_order_relaxed);
+}
+
+void Universe::syncRenderingLocked(const std::function<void(BitGrid&)>& apply) {
+	if (this->simulation_grid.isFileBacked()) return; // nothing is published for it, see publishLocked
+
+	std::lock_guard<std::mutex> publish_lock(this->publish_mutex);
+	if (this->publish_pending) {
+		apply(this->publish_buffer);
+	} // the waiting frame replaces the rendering grid soon, it needs the edit too
+
+	std::lock_guard<std::mutex> rendering_lock(this->rendering_mutex);
+	apply(this->rendering_grid);
+}
+
+uint64_t Universe::getGeneration() const {
+	return this->generation.load();
+}
+
+bool Universe::rewind(uint64_t generation) {
+	std::lock_guard<std::mutex> lock(this->grid_mutex);
+
+	if (this->recordsHistoryLocked() && this->history_edited && this->history.contains(this->generation)) {
+		this->recordHistoryLocked();
+	} // rewinding to the current generation has to bring back the edits made to it
+
+	if (!this->history.contains(generation) || this->history.getWidth() != this->getWidth() || this->history.getHeight() != this->getHeight()) {
+		std::cerr << "ERROR: Generation " << generation << " is not in the history" << std::endl;
+		return false;
+	} // exit if generation isn't retained
+
+	this->history.rebuild(generation, this->simulation_grid.words()); // frames use the grid's own word layout
+	this->stepper.invalidate();
+	this->generation = generation;
+	this->history.truncateAfter(generation); // stepping from here starts a new timeline
+	this->recountStatsLocked();
+	this->publishLocked(); // sync rendering grid
+	return true;
+}
+
+void Universe::setHistoryEnabled(bool enabled) {
+	std::lock_guard<std::mutex> lock(this->grid_mutex);
+	this->history_enabled = enabled;
+	if (!enabled) {
+		this->history.clear();
+		this->publishMemoryUsageLocked();
+	} // release memory
+}
+
+void Universe::setHistoryBudget(size_t bytes) {
+	std::lock_guard<std::mutex> lock(this->grid_mutex);
+	this->history_budget = bytes;
+	this->applyHistoryBudgetLocked();
+}
+
+void Universe::setBlockGenerations(int generations) {
+	std::lock_guard<std::mutex> lock(this->grid_mutex);
+	this->stepper.setBlockGenerations(generations);
+}
+
+void Universe::setThreadCount(unsigned int thread_count) {
+	std::lock_guard<std::mutex> lock(this->grid_mutex);
+	this->stepper.setThreadCount(thread_count);
+}
+
+void Universe::setThreadPinning(bool pin_threads) {
+	std::lock_guard<std::mutex> lock(this->grid_mutex);
+	this->stepper.setPinning(pin_threads);
+}
+
+void Universe::allocateGridLocked(BitGrid& grid, int width, int height) {
+	if (this->stepper.getThreadCount() > 1 && static_cast<int64_t>(width) * height >= PARALLEL_STEP_CELLS) {
+		this->stepper.allocate(grid, width, height); // each band's pages land on the node of the worker that steps it
+	} else {
+		grid.resize(width, height);
+	}
+}
+
+uint64_t Universe::getOldestRetainedGeneration() const {
+	std::lock_guard<std::mutex> lock(this->grid_mutex);
+	return this->history.getOldestGeneration();
+}
+
+bool Universe::recordsHistoryLocked() const {
+	return this->history_enabled && !this->simulation_grid.isFileBacked();
+}
+
+void Universe::recordHistoryLocked() {
+	this->history.record(this->generation, this->getWidth(), this->getHeight(), this->simulation_grid.words());
+	this->history_edited = false;
+}
+
+void Universe::restartTimelineLocked() {
+	this->generation = 0;
+	this->stepper.invalidate(); // a new board
+	this->history.clear();
+	this->history_edited = false;
+	this->applyHistoryBudgetLocked(); // the board may have changed size
+	this->recountStatsLocked();
+}
+
+void Universe::recountStatsLocked() {
+	GenerationStats stats;
+	stats.generation = this->generation;
+	for (int i = 0; i < this->getHeight(); i++) {
+		const uint64_t* row = this->simulation_grid.row(i);
+		TileStepper::accumulateRow(i, 0, row, row, this->simulation_grid.getWordsPerRow(), stats);
+	} // a replaced or rewound board has no step to gather stats or hash from, count it once
+
+	this->grid_hash = stats.hash;
+	this->cycle_detector.clear();
+	this->cycle_detector.update(stats.generation, stats.hash, stats.population); // the starting board is part of any cycle
+	this->publishStatsLocked(stats, false);
+}
+
+CycleDetector::Result Universe::getCycle() const {
+	std::lock_guard<std::mutex> lock(this->stats_mutex);
+	return this->cycle;
+}
+
+MemoryUsage Universe::getMemoryUsage() const {
+	MemoryUsage usage;
+	usage.simulation_grid = this->simulation_grid_bytes.load(std::memory_order_relaxed);
+	usage.step_buffer = this->step_buffer_bytes.load(std::memory_order_relaxed);
+	usage.publish_buffer = this->publish_buffer_bytes.load(std::memory_order_relaxed);
+	usage.rendering_grid = this->rendering_grid_bytes.load(std::memory_order_relaxed);
+	usage.history = this->history_bytes.load(std::memory_order_relaxed);
+	usage.tile_buffers = this->tile_buffer_bytes.load(std::memory_order_relaxed);
+	return usage;
+}
+
+void Universe::publishMemoryUsageLocked() {
+	this->simulation_grid_bytes.store(this->simulation_grid.getMemoryUsage(), std::memory_order_relaxed);
+	this->step_buffer_bytes.store(this->step_buffer.getMemoryUsage(), std::memory_order_relaxed);
+	this->history_bytes.store(this->history.getMemoryUsage(), std::memory_order_relaxed);
+	this->tile_buffer_bytes.store(this->stepper.getMemoryUsage() + this->zero_row.capacity() * sizeof(uint64_t), std::memory_order_relaxed);
+}
+
+void Universe::setMemoryBudget(size_t bytes) {
+	std::lock_guard<std::mutex> lock(this->grid_mutex);
+	this->memory_budget = bytes;
+	this->applyHistoryBudgetLocked();
+}
+
+size_t Universe::getMemoryBudget() const {
+	return this->memory_budget;
+}
+
+size_t Universe::estimateMemory(int width, int height) const {
+	if (width <= 0 || height <= 0) return 0;
+
+	// four grids (simulation, step, publish and rendering) plus the history's two working copies
+	double grid = static_cast<double>(height) * BitGrid::getRowStride(width) * sizeof(uint64_t);
+	double bytes = (this->history_enabled ? 6 : 4) * grid;
+
+	if (bytes >= static_cast<double>(std::numeric_limits<size_t>::max())) {
+		return std::numeric_limits<size_t>::max();
+	} // saturate instead of overflowing for absurd sizes
+	return static_cast<size_t>(bytes);
+}
+
+bool Universe::fitsMemoryBudget(int width, int height) const {
+	return this->estimateMemory(width, height) <= this->getBoardBudget();
+}
+
+int64_t Universe::getMaxCells() const {
+	double per_cell = (this->history_enabled ? 6 : 4) / 8.0; // one bit per cell and grid, row padding is ignored
+	return static_cast<int64_t>(this->getBoardBudget() / per_cell);
+}
+
+bool Universe::checkMemoryBudget(int width, int height) const {
+	if (this->fitsMemoryBudget(width, height)) return true;
+
+	std::string directory = GridArena::getBackingDirectory();
+	std::cerr << "ERROR: A " << width << " x " << height << " grid needs " << (this->estimateMemory(width, height) >> 20) << " MB, over the "
+		<< (directory.empty() ? "memory budget of " : "free space in " + directory + " of ") << (this->getBoardBudget() >> 20) << " MB" << std::endl;
+	return false;
+}
+
+size_t Universe::getBoardBudget() const {
+	std::string directory = GridArena::getBackingDirectory();
+	if (directory.empty()) return this->memory_budget;
+
+	std::error_code error;
+	std::filesystem::space_info space = std::filesystem::space(directory, error);
+	return error ? 0 : static_cast<size_t>(space.available);
+}
+
+void Universe::applyHistoryBudgetLocked() {
+	size_t board = GridArena::getBackingDirectory().empty() ? this->estimateMemory(this->getWidth(), this->getHeight()) : 0; // a board on disk leaves the memory to the history
+	size_t available = this->memory_budget > board ? this->memory_budget - board : 0;
+	this->history.setMemoryBudget(std::min(this->history_budget, available));
+	this->publishMemoryUsageLocked(); // a smaller budget drops frames
+}
+
+GenerationStats Universe::getStats() const {
+	std::lock_guard<std::mutex> lock(this->stats_mutex);
+	return this->stats;
+}
+
+void Universe::setStatsStream(std::ostream* stream) {
+	std::lock_guard<std::mutex> lock(this->grid_mutex);
+	this->stats_stream = stream;
+	if (this->stats_stream) {
+		*this->stats_stream << "generation,population,births,deaths,min_x,min_y,max_x,max_y,hash" << std::endl;
+	} // csv header
+}
+
+void Universe::clearCycleLocked() {
+	this->cycle_detector.clear();
+	std::lock_guard<std::mutex> lock(this->stats_mutex);
+	this->cycle = this->cycle_detector.getResult(); // readers mustn't go on seeing the cycle of the board before the edit
+}
+
+void Universe::publishStatsLocked(const GenerationStats& stats, bool append_to_stream) {
+	{
+		std::lock_guard<std::mutex> lock(this->stats_mutex);
+		this->stats = stats;
+		this->cycle = this->cycle_detector.getResult();
+	}
+
+	if (this->stats_stream && append_to_stream) {
+		*this->stats_stream << stats.generation << ',' << stats.population << ',' << stats.births << ',' << stats.deaths << ','
+			<< stats.min_x << ',' << stats.min_y << ',' << stats.max_x << ',' << stats.max_y << ',' << stats.hash << '\n';
+	} // append to the stats stream
 }
@@ -3,37 +3,145 @@
 #include <string>
 #include <mutex>
 #include <vector>
+#include <functional>
+#include <atomic>
+#include <cstdint>
+#include <algorithm>
+#include <ostream>
+#include <istream>
+#include "EditQueue.h"
+#include "GenerationHistory.h"
+#include "CycleDetector.h"
+#include "BitGrid.h"
+#include "GenerationStats.h"
+#include "TileStepper.h"
+#include "PatternFile.h"
+#include "Stamp.h"
 
 enum class CellState {
 	Dead,
 	Alive
 };
 
-typedef std::vector<std::vector<CellState>> Grid;
+// bytes held by each buffer a universe owns
+struct MemoryUsage {
+	size_t simulation_grid = 0;
+	size_t step_buffer = 0; // next generation is built here, then swapped with the simulation grid
+	size_t publish_buffer = 0;
+	size_t rendering_grid = 0;
+	size_t history = 0; // compressed frames plus the history's own working copies
+	size_t tile_buffers = 0; // cache sized buffers of the blocked stepper
+
+	size_t total() const {
+		return this->simulation_grid + this->step_buffer + this->publish_buffer + this->rendering_grid + this->history + this->tile_buffers;
+	}
+};
 
 class Universe {
 public:
 	Universe(int width = 100, int height = 100, int percent = 0);
 	void reset();
-	int countNeighbors(int cell_x, int cell_y);
-	void nextGeneration();
+	void nextGeneration(bool publish = true); // publish = false leaves the rendering grid on an older generation
+	void step(uint64_t generations, bool publish = true); // several generations per pass over memory, only the final generation is seen by stats, history and cycle detection
+	uint64_t advance(uint64_t generations, bool stop_on_cycle = false); // generations one by one under a single lock, publishes only the last, returns how many ran
 	void setCellState(int cell_x, int cell_y, CellState state);
+	void submitEdit(EditBatch batch); // queue edits without locking, they're applied before the next generation
+	void applyPendingEdits(); // apply queued edits now, used while the simulation isn't running
+	bool stamp(const Stamp& pattern, int x, int y, StampMode mode); // pattern's top left cell at x, y, clipped to the board, returns whether a cell changed
+	Stamp copyRegion(int x, int y, int width, int height); // cells of a rectangle clipped to the board, empty if none are on it
+	bool clearRegion(int x, int y, int width, int height); // region edits are clipped to the board, a word at a time, and return whether a cell changed
+	bool invertRegion(int x, int y, int width, int height);
+	bool randomizeRegion(int x, int y, int width, int height, int percent, unsigned int seed);
 	CellState getCellState(int cell_x, int cell_y) const;
 	int getWidth() const;
 	int getHeight() const;
-	void setGridSize(int width, int height);
-	void loadFromFile(std::string& filename);
-	void exportToFile(std::string& filename);
+	bool setGridSize(int width, int height); // returns false and keeps the board if the size doesn't fit the memory budget
+	bool loadFromFile(std::string& filename); // dense, .cells or Life 1.06, told apart by the first line and then the extension
+	bool loadFromStream(std::istream& input, PatternFile::Format format = PatternFile::Format::Dense); // the board is kept if the input is rejected
+	bool loadPattern(const SparsePattern& pattern); // board just big enough for the pattern, with the pattern in its top left corner
+	void exportToFile(std::string& filename); // .cells and .lif/.life names get those formats, anything else the dense one
 	void display(); // for debug reasons
-	void initialize(int width, int height, int percent); // initialize a random simulation_grid
-	const Grid& getRenderingGrid();
+	bool initialize(int width, int height, int percent); // initialize a random simulation_grid
+	bool initialize(int width, int height, int percent, unsigned int seed); // reproducible random simulation_grid
+	void publish(); // copy the simulation grid to the rendering grid
+	void readRenderingGrid(const std::function<void(const BitGrid&)>& reader); // reader runs while the rendering grid is locked, a frame published meanwhile is picked up first
+	void copyPackedGrid(std::vector<uint64_t>& packed, int& width, int& height) const; // one bit per cell, rows padded to whole words
+
+	uint64_t getGeneration() const; // generations stepped since the board was last loaded, randomized, resized or cleared
+	bool rewind(uint64_t generation); // restore a generation retained in the history
+	void setHistoryEnabled(bool enabled);
+	void setHistoryBudget(size_t bytes);
+	void setBlockGenerations(int generations); // generations step() advances per pass over memory
+	void setThreadCount(unsigned int thread_count); // threads stepping large boards, 0 uses every hardware thread and 1 keeps stepping on the calling thread
+	void setThreadPinning(bool pin_threads); // pin the stepping threads to cpus so boards stay on the numa node that steps them, on by default
+	uint64_t getOldestRetainedGeneration() const;
+
+	GenerationStats getStats() const; // stats of the latest generation (or the board as loaded), edits aren't counted until the next step
+	void setStatsStream(std::ostream* stream); // append a csv line per generation, nullptr to stop
+	CycleDetector::Result getCycle() const; // whether the board has become still or periodic
+	MemoryUsage getMemoryUsage() const; // as of the last step, publish or board change, never waits on a step
+	void setMemoryBudget(size_t bytes); // limit for boards created from now on, the history is trimmed to what the board leaves
+	size_t getMemoryBudget() const;
+	size_t estimateMemory(int width, int height) const; // bytes a board of this size needs, without the history's frames
+	bool fitsMemoryBudget(int width, int height) const;
+	int64_t getMaxCells() const; // largest board the budget allows
 
 	mutable std::mutex grid_mutex; // for thread safety
 	
 private:
-	Grid createEmptyGrid(int width, int height);
+	bool setCellLocked(int cell_x, int cell_y, bool alive); // returns whether the cell changed, keeps the hash up to date
+	bool checkMemoryBudget(int width, int height) const; // prints an error if the board doesn't fit
+	size_t getBoardBudget() const; // memory budget, or free disk space when grids go to the arena's backing file
+	void allocateGridLocked(BitGrid& grid, int width, int height); // empty board, placed for the threads that will step it
+	void applyHistoryBudgetLocked(); // history gets whatever the board leaves of the memory budget
+	void publishLocked(); // publish while grid_mutex is held, never waits for the renderer, a file-backed board publishes an empty grid
+	void syncRenderingLocked(const std::function<void(BitGrid&)>& apply); // apply an edit to the rendering grid and any frame waiting to replace it
+	void applyEditsLocked(bool sync_rendering); // apply queued edits while grid_mutex is held
+	bool editRegionLocked(int x, int y, int width, int height, const std::function<uint64_t(int, int, uint64_t, uint64_t)>& edit); // edit(row, word index, word, mask of the word's columns in the region) returns the new word, keeps the hash, tiles and rendering grid up to date
+	bool recordsHistoryLocked() const; // history is on and the board is in memory, a file-backed board would be copied and compressed whole every generation
+	void recordHistoryLocked(); // store the current generation in the history while grid_mutex is held
+	void restartTimelineLocked(); // forget the history after the board is replaced
+	void recountStatsLocked(); // full count, only used when the board is replaced rather than stepped
+	void publishStatsLocked(const GenerationStats& stats, bool append_to_stream);
+	void clearCycleLocked(); // forget the detected cycle after an edit, the published copy too
+	void publishMemoryUsageLocked(); // figures for getMemoryUsage, the rendering grid's are kept up to date by publishLocked
+	void stepLocked(); // one generation with all its bookkeeping, while grid_mutex is held
+	void finishStepLocked(GenerationStats& stats, uint64_t generations); // bookkeeping shared by stepLocked and step
 	
-	Grid simulation_grid;
-	Grid rendering_grid;
+	BitGrid simulation_grid;
+	BitGrid step_buffer; // reused every generation
+	BitGrid rendering_grid;
+	BitGrid publish_buffer; // back buffer so the rendering lock is only held for a swap
+	bool publish_pending = false; // publish_buffer holds a frame the renderer was too busy to take, guarded by publish_mutex
+	std::vector<uint64_t> zero_row; // stands in for the rows above and below the board
+	TileStepper stepper;
+	mutable std::mutex rendering_mutex; // guards rendering_grid only, so rendering never blocks stepping
+	std::mutex publish_mutex; // guards publish_buffer and publish_pending, each side only try_locks the other's mutex so neither waits on a frame
+	EditQueue pending_edits;
+
+	std::atomic<uint64_t> generation{0};
+	GenerationHistory history;
+	bool history_enabled = true;
+	bool history_edited = false; // the board was edited after the current generation was recorded, it's recorded again before stepping or rewinding
+	size_t history_budget = 64 * 1024 * 1024;
+	size_t memory_budget = size_t(2) * 1024 * 1024 * 1024;
+
+	GenerationStats stats;
+	mutable std::mutex stats_mutex; // small lock so reading stats never waits on a step
+	std::ostream* stats_stream = nullptr;
+
+	// memory figures published while grid_mutex is held, so reading them never waits on a step
+	std::atomic<size_t> simulation_grid_bytes{0};
+	std::atomic<size_t> step_buffer_bytes{0};
+	std::atomic<size_t> publish_buffer_bytes{0};
+	std::atomic<size_t> rendering_grid_bytes{0};
+	std::atomic<size_t> history_bytes{0};
+	std::atomic<size_t> tile_buffer_bytes{0};
+
+	uint64_t grid_hash = 0; // xor of BitGrid::wordHash over the board, recomputed by steps and updated by edits
+	CycleDetector cycle_detector;
+	CycleDetector::Result cycle; // copy of the detector's result, guarded by stats_mutex
+
+	static constexpr int64_t PARALLEL_STEP_CELLS = int64_t(1) << 20; // smaller boards step faster on one thread than they'd take to hand out
 };
 
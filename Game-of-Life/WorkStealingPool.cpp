@@ -0,0 +1,138 @@
+#include "WorkStealingPool.h"
+#include "ThreadAffinity.h"
+#include <algorithm>
+#include <iostream>
+
+thread_local WorkStealingPool* WorkStealingPool::current_pool = nullptr;
+thread_local unsigned int WorkStealingPool::current_index = 0;
+
+WorkStealingPool::WorkStealingPool(unsigned int thread_count, bool pin_threads) {
+	if (thread_count == 0) {
+		thread_count = std::max(1u, std::thread::hardware_concurrency());
+	} // use every hardware thread by default
+
+	for (unsigned int i = 0; i < thread_count; i++) {
+		this->workers.emplace_back(new Worker());
+	}
+
+	for (unsigned int i = 0; i < thread_count; i++) {
+		this->threads.emplace_back(&WorkStealingPool::workerLoop, this, i, pin_threads);
+	} // start workers after every deque exists so stealing never sees a missing one
+}
+
+WorkStealingPool::~WorkStealingPool() {
+	this->wait();
+
+	{
+		std::lock_guard<std::mutex> lock(this->sleep_mutex);
+		this->stopping.store(true);
+	}
+	this->sleep_cv.notify_all();
+
+	for (auto& thread : this->threads) {
+		thread.join();
+	}
+}
+
+void WorkStealingPool::submit(std::function<void()> task) {
+	unsigned int index = (WorkStealingPool::current_pool == this)
+		? WorkStealingPool::current_index
+		: this->next_worker.fetch_add(1) % this->workers.size();
+
+	this->submitTo(index, std::move(task));
+}
+
+void WorkStealingPool::submitTo(unsigned int worker, std::function<void()> task) {
+	unsigned int index = worker % this->workers.size();
+
+	this->pending.fetch_add(1);
+	this->queued.fetch_add(1); // counted before it's visible so the counter never goes below zero
+	{
+		std::lock_guard<std::mutex> lock(this->workers[index]->mutex);
+		this->workers[index]->tasks.push_back(std::move(task));
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(this->sleep_mutex);
+	} // pairs with the predicate check so a worker going to sleep can't miss this task
+	this->sleep_cv.notify_one();
+}
+
+void WorkStealingPool::wait() {
+	std::unique_lock<std::mutex> lock(this->sleep_mutex);
+	this->done_cv.wait(lock, [this]() {
+		return this->pending.load() == 0;
+	});
+}
+
+unsigned int WorkStealingPool::getThreadCount() const {
+	return static_cast<unsigned int>(this->workers.size());
+}
+
+int WorkStealingPool::getCurrentWorkerIndex() const {
+	return WorkStealingPool::current_pool == this ? static_cast<int>(WorkStealingPool::current_index) : -1;
+}
+
+void WorkStealingPool::workerLoop(unsigned int index, bool pin_thread) {
+	WorkStealingPool::current_pool = this;
+	WorkStealingPool::current_index = index;
+
+	if (pin_thread) {
+		const std::vector<int>& cpus = ThreadAffinity::getCpus();
+		if (!ThreadAffinity::pinCurrentThread(cpus[index % cpus.size()])) {
+			std::cerr << "ERROR: Couldn't pin worker " << index << " to cpu " << cpus[index % cpus.size()] << std::endl;
+		} // keeps running unpinned
+	} // cpus are ordered node by node, so neighbouring workers share a node
+
+	while (true) {
+		std::function<void()> task;
+
+		if (this->popLocal(index, task) || this->steal(index, task)) {
+			this->queued.fetch_sub(1);
+
+			try {
+				task();
+			} catch (const std::exception& e) {
+				std::cerr << "ERROR: Exception in pool task: " << e.what() << std::endl;
+			} catch (...) {
+				std::cerr << "ERROR: Unknown exception in pool task" << std::endl;
+			}
+
+			if (this->pending.fetch_sub(1) == 1) {
+				std::lock_guard<std::mutex> lock(this->sleep_mutex);
+				this->done_cv.notify_all();
+			} // last task finished
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(this->sleep_mutex);
+		this->sleep_cv.wait(lock, [this]() {
+			return this->stopping.load() || this->queued.load() > 0;
+		}); // sleep until there's something to take or steal
+
+		if (this->stopping.load() && this->queued.load() == 0) return;
+	}
+}
+
+bool WorkStealingPool::popLocal(unsigned int index, std::function<void()>& task) {
+	Worker& worker = *this->workers[index];
+	std::lock_guard<std::mutex> lock(worker.mutex);
+	if (worker.tasks.empty()) return false;
+
+	task = std::move(worker.tasks.back()); // newest first keeps the worker's data warm
+	worker.tasks.pop_back();
+	return true;
+}
+
+bool WorkStealingPool::steal(unsigned int thief, std::function<void()>& task) {
+	for (size_t offset = 1; offset < this->workers.size(); offset++) {
+		Worker& victim = *this->workers[(thief + offset) % this->workers.size()];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		if (victim.tasks.empty()) continue;
+
+		task = std::move(victim.tasks.front()); // oldest first, usually the biggest remaining piece of work
+		victim.tasks.pop_front();
+		return true;
+	}
+	return false;
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// fixed set of worker threads, each with its own task deque
+// workers take new work from the back of their own deque and steal from the front of others when they run dry
+class WorkStealingPool {
+public:
+	explicit WorkStealingPool(unsigned int thread_count = 0, bool pin_threads = false); // 0 uses every hardware thread, pinned workers fill one numa node before the next
+	~WorkStealingPool();
+	WorkStealingPool(const WorkStealingPool&) = delete;
+	WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+	void submit(std::function<void()> task); // tasks submitted from a worker go to that worker's own deque
+	void submitTo(unsigned int worker, std::function<void()> task); // queue on a given worker, others can still steal it
+	void wait(); // block until every submitted task has finished, don't call from a task
+	unsigned int getThreadCount() const;
+	int getCurrentWorkerIndex() const; // index of the calling thread among this pool's workers, -1 for any other thread
+
+private:
+	struct Worker {
+		std::deque<std::function<void()>> tasks;
+		std::mutex mutex;
+	};
+
+	// ---- methods ----
+	void workerLoop(unsigned int index, bool pin_thread);
+	bool popLocal(unsigned int index, std::function<void()>& task);
+	bool steal(unsigned int thief, std::function<void()>& task);
+
+	// ---- attributes ----
+	std::vector<std::unique_ptr<Worker>> workers;
+	std::vector<std::thread> threads;
+	std::atomic<bool> stopping{false};
+	std::atomic<size_t> queued{0}; // tasks waiting in a deque
+	std::atomic<size_t> pending{0}; // tasks queued or running
+	std::atomic<unsigned int> next_worker{0}; // round robin target for tasks submitted from outside the pool
+	std::mutex sleep_mutex;
+	std::condition_variable sleep_cv; // idle workers wait here
+	std::condition_variable done_cv; // wait() waits here
+
+	static thread_local WorkStealingPool* current_pool; // pool the calling thread works for, if any
+	static thread_local unsigned int current_index;
+};
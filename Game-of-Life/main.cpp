@@ -1,6 +1,60 @@
 #include "Game.h"
+#include "SoupSearch.h"
+#include "Benchmark.h"
+#include "DistributedStepper.h"
+#include "EngineVerifier.h"
+#include "LoaderFuzzer.h"
+#include <cstring>
+#include <cstdio>
+#include <iostream>
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+// the exe is built for the windows subsystem, so the headless modes have no console of their own
+// attach to the one they were started from and point the standard streams at it, unless they were redirected
+static void attachParentConsole() {
+#ifdef _WIN32
+    HANDLE output = GetStdHandle(STD_OUTPUT_HANDLE);
+    if (output != nullptr && output != INVALID_HANDLE_VALUE) return; // already going to a file or pipe
+
+    if (!AttachConsole(ATTACH_PARENT_PROCESS)) return; // started without a console, e.g. from a shortcut
+
+    FILE* stream = nullptr;
+    freopen_s(&stream, "CONOUT$", "w", stdout);
+    freopen_s(&stream, "CONOUT$", "w", stderr);
+    freopen_s(&stream, "CONIN$", "r", stdin);
+    std::cout.clear();
+    std::cerr.clear();
+    std::cin.clear();
+#endif
+}
 
 int main(int argc, char* argv[]) {
+    if (argc > 1 && std::strncmp(argv[1], "--", 2) == 0) {
+        attachParentConsole();
+    } // every headless mode reports on the console
+    if (argc > 1 && std::strcmp(argv[1], "--soup-search") == 0) {
+        return SoupSearch::runFromArguments(argc, argv);
+    } // headless batch mode
+
+    if (argc > 1 && std::strcmp(argv[1], "--benchmark") == 0) {
+        return Benchmark::runFromArguments(argc, argv);
+    } // headless throughput benchmark
+
+    if (argc > 1 && std::strcmp(argv[1], "--distributed") == 0) {
+        return DistributedStepper::runFromArguments(argc, argv);
+    } // board split across local worker processes
+
+    if (argc > 1 && std::strcmp(argv[1], "--verify") == 0) {
+        return EngineVerifier::runFromArguments(argc, argv);
+    } // every stepping engine against the reference
+
+    if (argc > 1 && std::strcmp(argv[1], "--fuzz-loaders") == 0) {
+        return LoaderFuzzer::runFromArguments(argc, argv);
+    } // generated input through the pattern loaders
+
     Game game;
     game.run();
     return 0;